@@ -0,0 +1,186 @@
+#include "kl/binary_rw.hpp"
+#include "kl/binary_rw/array.hpp"
+#include "kl/binary_rw/binary_size.hpp"
+#include "kl/binary_rw/columnar.hpp"
+#include "kl/binary_rw/delta.hpp"
+#include "kl/binary_rw/deque.hpp"
+#include "kl/binary_rw/endian.hpp"
+#include "kl/binary_rw/flat_map.hpp"
+#include "kl/binary_rw/flat_set.hpp"
+#include "kl/binary_rw/framed.hpp"
+#include "kl/binary_rw/map.hpp"
+#include "kl/binary_rw/optional.hpp"
+#include "kl/binary_rw/pair.hpp"
+#include "kl/binary_rw/record_file.hpp"
+#include "kl/binary_rw/reflectable.hpp"
+#include "kl/binary_rw/set.hpp"
+#include "kl/binary_rw/stream_reader.hpp"
+#include "kl/binary_rw/string.hpp"
+#include "kl/binary_rw/unordered_map.hpp"
+#include "kl/binary_rw/unordered_set.hpp"
+#include "kl/binary_rw/variant.hpp"
+#include "kl/binary_rw/varint.hpp"
+#include "kl/binary_rw/vector.hpp"
+#include "kl/reflect_struct.hpp"
+
+#include <boost/endian/arithmetic.hpp>
+#include <gsl/span>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+struct packed
+{
+    std::uint32_t id;
+    std::array<std::uint16_t, 2> pair;
+};
+KL_REFLECT_STRUCT(packed, id, pair)
+
+struct message
+{
+    kl::varint<std::int64_t> id;
+    std::string name;
+    std::vector<packed> items;
+    std::map<std::uint16_t, std::vector<std::string>> groups;
+    std::set<std::int32_t> tags;
+    std::unordered_map<std::string, double> metrics;
+    std::unordered_set<std::uint64_t> seen;
+    std::deque<std::optional<std::string>> history;
+    boost::container::flat_map<std::int32_t, std::uint8_t> flags;
+    boost::container::flat_set<std::string> labels;
+    std::variant<std::uint8_t, boost::endian::big_int32_t, std::string> var;
+    std::pair<std::uint8_t, std::vector<float>> extra;
+    std::array<std::string, 2> names;
+    kl::columnar<std::vector<packed>> columns;
+    kl::delta_encoded<std::vector<std::int64_t>> timestamps;
+};
+KL_REFLECT_STRUCT(message, id, name, items, groups, tags, metrics, seen,
+                  history, flags, labels, var, extra, names, columns,
+                  timestamps)
+
+struct message_view
+{
+    std::string_view name;
+    gsl::span<const std::uint32_t> values;
+};
+KL_REFLECT_STRUCT(message_view, name, values)
+
+// Reads everything from the reader and, if it succeeds, checks the result
+// survives a round trip
+void read_message(kl::binary_reader& r)
+{
+    const auto msg = r.read<message>();
+    if (r.err())
+        return;
+
+    const auto buf = kl::serialize_to_vector(msg, r.prefix_format());
+    kl::binary_reader r2{buf};
+    r2.set_prefix_format(r.prefix_format());
+    r2.read<message>();
+    if (r2.err() || !r2.empty())
+        __builtin_trap();
+}
+
+// Goes through all frames, or up to the first bad one, decoding each
+void read_frames(kl::binary_reader& r)
+{
+    kl::framed_reader fr{r, 64 * 1024};
+    while (auto frame = fr.next())
+        read_message(*frame);
+}
+
+// Opens input as a record file and decodes all its records
+void read_record_file(gsl::span<const std::byte> input)
+{
+    try
+    {
+        kl::record_file file{input};
+        for (const auto rec : file)
+        {
+            auto r = file.reader(rec);
+            read_message(r);
+        }
+    }
+    catch (const kl::record_file_error&)
+    {
+    }
+}
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data,
+                                      std::size_t size)
+{
+    if (size < 1)
+        return 0;
+
+    // First byte picks the settings
+    const auto format =
+        data[0] & 1 ? kl::length_format::varint : kl::length_format::fixed32;
+    const std::size_t budget = std::size_t{1} << (10 + (data[0] >> 4));
+    const auto input = gsl::span{data + 1, size - 1};
+
+    {
+        kl::binary_reader r{input};
+        r.set_prefix_format(format);
+        r.set_alloc_budget(budget);
+        read_message(r);
+    }
+
+    {
+        kl::binary_reader r{input};
+        r.set_prefix_format(format);
+        r.read<message_view>();
+    }
+
+    {
+        std::size_t offset = 0;
+        kl::stream_binary_reader r{
+            [&](gsl::span<std::byte> out) {
+                // Small chunks to exercise refills
+                const auto count =
+                    (std::min)({out.size(), input.size() - offset,
+                                std::size_t{7}});
+                std::memcpy(out.data(), input.data() + offset, count);
+                offset += count;
+                return count;
+            },
+            64};
+        r.set_prefix_format(format);
+        r.set_alloc_budget(budget);
+        read_message(r);
+    }
+
+    {
+        kl::binary_reader r{input};
+        r.set_prefix_format(format);
+        r.set_alloc_budget(budget);
+        read_frames(r);
+    }
+
+    {
+        // Frames that aren't buffered are copied out, without a budget only
+        // max_frame_size limits them
+        std::size_t offset = 0;
+        kl::stream_binary_reader r{
+            [&](gsl::span<std::byte> out) {
+                const auto count =
+                    (std::min)({out.size(), input.size() - offset,
+                                std::size_t{13}});
+                std::memcpy(out.data(), input.data() + offset, count);
+                offset += count;
+                return count;
+            },
+            64};
+        r.set_prefix_format(format);
+        read_frames(r);
+    }
+
+    read_record_file(gsl::as_bytes(input));
+
+    return 0;
+}
@@ -7,9 +7,19 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
 
 namespace kl {
 
+// How length prefixes of strings and containers are encoded
+enum class length_format
+{
+    fixed32, // uint32_t in native byte order (default)
+    varint   // LEB128, 1 byte for lengths below 128
+};
+
 namespace detail {
 
 template <typename T>
@@ -56,6 +66,10 @@ public:
     // Useful in user-provided operator>> for composite types to fail fast
     void notify_error() noexcept { err_ = true; }
 
+    // Reader and writer must agree on this one
+    void set_prefix_format(length_format format) noexcept { format_ = format; }
+    length_format prefix_format() const noexcept { return format_; }
+
 protected:
     T* cursor() const noexcept { return buffer_.data() + pos_; }
 
@@ -63,6 +77,7 @@ protected:
     gsl::span<T> buffer_;
     std::size_t pos_{0};
     bool err_{false};
+    length_format format_{length_format::fixed32};
 };
 
 template <typename T>
@@ -71,11 +86,53 @@ using is_simple =
 
 } // namespace detail
 
+// Types whose binary representation is just their object representation so
+// contiguous ranges of them (i.e. std::vector<T>) can be read and written with
+// one memcpy. Specialize for your own trivially copyable types to opt in, their
+// write_binary/read_binary must then be equivalent to write_raw/read_raw.
+template <typename T, typename = void>
+struct is_trivially_serializable : detail::is_simple<T>
+{
+};
+
+template <typename T>
+inline constexpr bool is_trivially_serializable_v =
+    is_trivially_serializable<T>::value;
+
+// Smallest number of bytes any value of T is encoded with, used to reject
+// length prefixes claiming more elements than there are bytes left. Everything
+// in binary_rw takes at least one byte. Specialize for your own types if they
+// can be encoded with less.
+template <typename T, typename = void>
+struct min_binary_size
+    : std::integral_constant<std::size_t, is_trivially_serializable_v<T>
+                                              ? sizeof(T)
+                                              : 1>
+{
+};
+
+template <typename T>
+inline constexpr std::size_t min_binary_size_v = min_binary_size<T>::value;
+
+template <typename T1, typename T2>
+struct min_binary_size<std::pair<T1, T2>>
+    : std::integral_constant<std::size_t, min_binary_size_v<T1> +
+                                              min_binary_size_v<T2>>
+{
+};
+
 class binary_reader : public detail::cursor_base<const std::byte>
 {
 public:
     using detail::cursor_base<const std::byte>::cursor_base;
 
+    // Derived readers (stream_binary_reader) may own buffers and be deleted
+    // through a pointer to the base
+    virtual ~binary_reader() = default;
+
+    binary_reader(const binary_reader&) = default;
+    binary_reader& operator=(const binary_reader&) = default;
+
     template <typename T>
     bool peek(T& value) noexcept
     {
@@ -137,7 +194,7 @@ public:
     // Does not copy the data
     gsl::span<const std::byte> span(std::size_t count, bool move_cursor = true)
     {
-        if (count > static_cast<std::size_t>(left()))
+        if (!err_ && count > static_cast<std::size_t>(left()) && !refill(count))
             err_ = true;
         if (err_)
             return {};
@@ -149,10 +206,46 @@ public:
         return ret;
     }
 
+    // Upper bound of how many bytes can still be read. Same as left() unless
+    // the reader can pull more data on demand.
+    virtual std::size_t max_left() const noexcept { return left(); }
+
+    // Caps the total memory read_binary overloads may allocate for decoded
+    // data (see read_count). Unlimited by default.
+    void set_alloc_budget(std::size_t bytes) noexcept { budget_ = bytes; }
+    std::size_t alloc_budget() const noexcept { return budget_; }
+
+    // Takes `bytes` from the allocation budget. Sets err() and leaves the
+    // budget intact if that's more than what's left.
+    bool charge_alloc(std::size_t bytes) noexcept
+    {
+        if (bytes > budget_)
+            err_ = true;
+        if (err_)
+            return false;
+
+        budget_ -= bytes;
+        return true;
+    }
+
+protected:
+    // Readers pulling data from a stream (stream_binary_reader) override the
+    // two below. refill() must make at least `size` bytes available in the
+    // buffer, underflow() must read `size` bytes to `data` when they are not.
+    virtual bool refill(std::size_t) noexcept { return false; }
+
+    virtual bool underflow(std::byte*, std::size_t) noexcept
+    {
+        err_ = true;
+        return false;
+    }
+
 private:
     bool peek_impl(std::byte* data, std::size_t size) noexcept
     {
-        if (err_ || static_cast<std::size_t>(left()) < size)
+        if (err_)
+            return false;
+        if (static_cast<std::size_t>(left()) < size && !refill(size))
             return false;
 
         std::memcpy(data, cursor(), size);
@@ -161,13 +254,22 @@ private:
 
     bool read_impl(std::byte* data, std::size_t size) noexcept
     {
-        if (peek_impl(data, size))
-            pos_ += size;
-        else
-            err_ = true;
+        if (err_)
+            return false;
+        // Empty spans and readers over no data may have null pointers
+        if (size == 0)
+            return true;
+        if (static_cast<std::size_t>(left()) < size)
+            return underflow(data, size);
 
-        return !err_;
+        std::memcpy(data, cursor(), size);
+        pos_ += size;
+
+        return true;
     }
+
+private:
+    std::size_t budget_{(std::numeric_limits<std::size_t>::max)()};
 };
 
 // read_binary implementation for all basic types + enum types
@@ -177,8 +279,10 @@ void read_binary(binary_reader& r, T& value) noexcept
     r.read_raw(value);
 }
 
-// read_binary implementation for all basic types + enum types
-template <typename T, std::size_t Extent>
+// read_binary implementation for spans, fills the whole span. See below for
+// spans of const T.
+template <typename T, std::size_t Extent,
+          enable_if<std::negation<std::is_const<T>>> = true>
 void read_binary(binary_reader& r, gsl::span<T, Extent> span)
 {
     r.read_span(span);
@@ -192,7 +296,8 @@ binary_reader& operator>>(binary_reader& r, T& value)
 }
 
 // This must be present to allow for rvalue spans
-template <typename T, std::size_t Extent>
+template <typename T, std::size_t Extent,
+          enable_if<std::negation<std::is_const<T>>> = true>
 binary_reader& operator>>(binary_reader& r, gsl::span<T, Extent> span)
 {
     read_binary(r, span);
@@ -204,6 +309,12 @@ class binary_writer : public detail::cursor_base<std::byte>
 public:
     using detail::cursor_base<std::byte>::cursor_base;
 
+    // Like binary_reader, derived writers own blocks or buffers
+    virtual ~binary_writer() = default;
+
+    binary_writer(const binary_writer&) = default;
+    binary_writer& operator=(const binary_writer&) = default;
+
     template <typename T>
     bool write_raw(const T& value) noexcept
     {
@@ -216,8 +327,24 @@ public:
                           sizeof(T));
     }
 
+    // Spans of at least reference_threshold_ bytes may be referenced instead
+    // of copied (see gather_binary_writer), they must outlive the writer's
+    // output then
     template <typename T, std::size_t Extent>
     bool write_span(gsl::span<const T, Extent> span) noexcept
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "T must be a trivially copyable type");
+
+        const auto* data = reinterpret_cast<const std::byte*>(span.data());
+        if (span.size_bytes() >= reference_threshold_ && !err_)
+            return reference(data, span.size_bytes());
+        return write_impl(data, span.size_bytes());
+    }
+
+    // Like write_span but always copies, for temporary buffers
+    template <typename T, std::size_t Extent>
+    bool copy_span(gsl::span<const T, Extent> span) noexcept
     {
         static_assert(std::is_trivially_copyable<T>::value,
                       "T must be a trivially copyable type");
@@ -226,14 +353,35 @@ public:
                           span.size_bytes());
     }
 
+protected:
+    // Called when `size` bytes don't fit in what's left of the buffer. Writers
+    // that can grow (growable_binary_writer) take over the write from here.
+    virtual bool overflow(const std::byte*, std::size_t) noexcept
+    {
+        err_ = true;
+        return false;
+    }
+
+    // Called instead of copying spans of at least reference_threshold_ bytes
+    virtual bool reference(const std::byte* data, std::size_t size) noexcept
+    {
+        return write_impl(data, size);
+    }
+
+protected:
+    std::size_t reference_threshold_{(std::numeric_limits<std::size_t>::max)()};
+
 private:
     bool write_impl(const std::byte* data, std::size_t size) noexcept
     {
-        if (err_ || static_cast<std::size_t>(left()) < size)
-        {
-            err_ = true;
+        if (err_)
             return false;
-        }
+        // Writers starting with no buffer (counting_binary_writer and such)
+        // would pass null pointers to memcpy for empty spans
+        if (size == 0)
+            return true;
+        if (static_cast<std::size_t>(left()) < size)
+            return overflow(data, size);
 
         std::memcpy(cursor(), data, size);
         pos_ += size;
@@ -262,4 +410,215 @@ binary_writer& operator<<(binary_writer& w, const T& value)
     write_binary(w, value);
     return w;
 }
+
+namespace detail {
+
+template <typename U>
+inline constexpr std::size_t max_leb128_size =
+    (std::numeric_limits<U>::digits + 6) / 7;
+
+template <typename U>
+bool write_leb128(binary_writer& w, U value) noexcept
+{
+    static_assert(std::is_unsigned_v<U>);
+
+    std::byte buf[max_leb128_size<U>];
+    std::size_t size = 0;
+    while (value >= 0x80)
+    {
+        buf[size++] = static_cast<std::byte>(value | 0x80);
+        value >>= 7;
+    }
+    buf[size++] = static_cast<std::byte>(value);
+
+    return w.copy_span(gsl::span<const std::byte>{buf, size});
+}
+
+// Returns the number of bytes decoded or 0 if `data` doesn't hold a valid
+// LEB128 encoded value of type U (it's truncated, too long or overflows)
+template <typename U>
+std::size_t decode_leb128(const std::byte* data, std::size_t size,
+                          U& value) noexcept
+{
+    constexpr auto max_size = max_leb128_size<U>;
+    // How many bits of the last byte are in use
+    constexpr auto last_bits =
+        std::numeric_limits<U>::digits - 7 * (max_size - 1);
+
+    U ret = 0;
+    const auto count = size < max_size ? size : max_size;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto byte = std::to_integer<unsigned>(data[i]);
+        ret |= static_cast<U>(static_cast<U>(byte & 0x7F) << (7 * i));
+        if (!(byte & 0x80))
+        {
+            if (i == max_size - 1 && (byte >> last_bits) != 0)
+                return 0;
+            value = ret;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+template <typename U>
+bool read_leb128(binary_reader& r, U& value) noexcept
+{
+    static_assert(std::is_unsigned_v<U>);
+    constexpr auto max_size = max_leb128_size<U>;
+
+    if (r.err())
+        return false;
+
+    // Fast path: enough bytes are buffered so there's no need to check for
+    // each one of them if it's there
+    if (r.left() >= max_size)
+    {
+        const auto size =
+            decode_leb128(r.span(max_size, false).data(), max_size, value);
+        if (size == 0)
+        {
+            r.notify_error();
+            return false;
+        }
+        r.skip(static_cast<std::ptrdiff_t>(size));
+        return true;
+    }
+
+    std::byte buf[max_size];
+    for (std::size_t i = 0; i < max_size; ++i)
+    {
+        if (!r.read_raw(buf[i]))
+            return false;
+        if (!(std::to_integer<unsigned>(buf[i]) & 0x80))
+            break;
+    }
+
+    if (decode_leb128(buf, max_size, value) == 0)
+    {
+        r.notify_error();
+        return false;
+    }
+    return true;
+}
+} // namespace detail
+
+// Writes/reads the length prefix of a string or container in the format set
+// with set_prefix_format(). Use them in read_binary/write_binary for your own
+// containers too.
+inline void write_length(binary_writer& w, std::size_t length) noexcept
+{
+    const auto length32 = static_cast<std::uint32_t>(length);
+    if (w.prefix_format() == length_format::varint)
+        detail::write_leb128(w, length32);
+    else
+        w.write_raw(length32);
+}
+
+inline std::uint32_t read_length(binary_reader& r) noexcept
+{
+    std::uint32_t length = 0;
+    if (r.prefix_format() == length_format::varint)
+        detail::read_leb128(r, length);
+    else
+        r.read_raw(length);
+    return r.err() ? 0 : length;
+}
+
+// Reads the length prefix of a sequence of T, to be decoded into a container.
+// Doesn't trust it: fails (setting err() and returning 0) if there's not enough
+// data left for that many elements or they wouldn't fit in the allocation
+// budget. Use it before resize()/reserve() in read_binary for containers.
+template <typename T>
+std::uint32_t read_count(binary_reader& r) noexcept
+{
+    const auto count = read_length(r);
+    if (count == 0)
+        return 0;
+
+    constexpr auto min_size = min_binary_size_v<T>;
+    if constexpr (min_size > 0)
+    {
+        if (count > r.max_left() / min_size)
+        {
+            r.notify_error();
+            return 0;
+        }
+    }
+
+    constexpr auto max_count =
+        (std::numeric_limits<std::size_t>::max)() / sizeof(T);
+    if (count > max_count || !r.charge_alloc(count * sizeof(T)))
+    {
+        r.notify_error();
+        return 0;
+    }
+    return count;
+}
+
+// Number of elements a container may allocate up front for a sequence of
+// `count` elements of T. All of them if the reader knows how much data is
+// left (read_count() checked the count against it then). Readers pulling from
+// a stream don't, a hostile length prefix would be trusted until the data
+// runs out, so there it's at most 64 KiB worth and containers grow as the
+// elements actually arrive.
+template <typename T>
+std::size_t initial_capacity(const binary_reader& r, std::size_t count) noexcept
+{
+    constexpr auto max_initial =
+        (std::max)(std::size_t{1}, std::size_t{64 * 1024} / sizeof(T));
+    if (r.max_left() != (std::numeric_limits<std::size_t>::max)())
+        return count;
+    return (std::min)(count, max_initial);
+}
+
+namespace detail {
+
+// Resizes `seq` to `size` elements of T and reads them as one span, or in
+// steps of initial_capacity() if the reader can't vouch for the data
+template <typename T, typename Seq>
+bool read_contiguous(binary_reader& r, Seq& seq, std::size_t size)
+{
+    for (std::size_t done = 0; done < size;)
+    {
+        const auto chunk = initial_capacity<T>(r, size - done);
+        seq.resize(done + chunk);
+        if (!r.read_span(gsl::span<T>{seq.data() + done, chunk}))
+            return false;
+        done += chunk;
+    }
+    return true;
+}
+} // namespace detail
+
+// Reads a length-prefixed sequence (as written for std::vector<T>) without
+// copying it: the span points into the reader's buffer. Sets err() if the data
+// isn't suitably aligned for T. With stream_binary_reader the view is only
+// valid until the next read.
+template <typename T, enable_if<is_trivially_serializable<T>> = true>
+void read_binary(binary_reader& r, gsl::span<const T>& view) noexcept
+{
+    view = {};
+    const auto length = read_length(r);
+    if (r.err() || length == 0)
+        return;
+    if (length > (std::numeric_limits<std::size_t>::max)() / sizeof(T))
+    {
+        r.notify_error();
+        return;
+    }
+
+    const auto bytes = r.span(length * sizeof(T), false);
+    if (r.err())
+        return;
+    if (reinterpret_cast<std::uintptr_t>(bytes.data()) % alignof(T) != 0)
+    {
+        r.notify_error();
+        return;
+    }
+
+    view = {reinterpret_cast<const T*>(bytes.data()), length};
+    r.skip(static_cast<std::ptrdiff_t>(bytes.size()));
+}
 } // namespace kl
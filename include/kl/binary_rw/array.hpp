@@ -0,0 +1,58 @@
+#pragma once
+
+#include "kl/binary_rw.hpp"
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+namespace kl {
+
+// std::array has no padding between (nor after) its elements so it's as
+// trivially serializable as its elements are
+template <typename T, std::size_t N>
+struct is_trivially_serializable<std::array<T, N>>
+    : std::bool_constant<is_trivially_serializable_v<T> &&
+                         sizeof(std::array<T, N>) == N * sizeof(T)>
+{
+};
+
+template <typename T, std::size_t N>
+struct min_binary_size<std::array<T, N>>
+    : std::integral_constant<std::size_t, N * min_binary_size_v<T>>
+{
+};
+
+// No size prefix, the size is known up front
+template <typename T, std::size_t N>
+void write_binary(kl::binary_writer& w, const std::array<T, N>& arr)
+{
+    if constexpr (is_trivially_serializable_v<T>)
+    {
+        w << gsl::span<const T>{arr};
+    }
+    else
+    {
+        for (const auto& item : arr)
+            w << item;
+    }
+}
+
+template <typename T, std::size_t N>
+void read_binary(kl::binary_reader& r, std::array<T, N>& arr)
+{
+    if constexpr (is_trivially_serializable_v<T>)
+    {
+        r >> gsl::span<T>{arr};
+    }
+    else
+    {
+        for (auto& item : arr)
+        {
+            if (r.err())
+                break;
+            r >> item;
+        }
+    }
+}
+} // namespace kl
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "kl/binary_rw.hpp"
+#include "kl/binary_rw/reflectable.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace kl {
+
+// binary_writer which doesn't write anything, it only counts the bytes.
+// Whatever is written as a span (i.e. vectors of trivially serializable types
+// or strings) is counted in O(1).
+class counting_binary_writer final : public binary_writer
+{
+public:
+    counting_binary_writer() noexcept : binary_writer{gsl::span<std::byte>{}}
+    {
+    }
+
+    // Returns the number of bytes written so far
+    std::size_t size() const noexcept { return size_; }
+
+protected:
+    bool overflow(const std::byte*, std::size_t size) noexcept override
+    {
+        size_ += size;
+        return true;
+    }
+
+private:
+    std::size_t size_{0};
+};
+
+namespace detail {
+
+template <typename T>
+struct is_std_array : std::false_type
+{
+};
+
+template <typename T, std::size_t N>
+struct is_std_array<std::array<T, N>> : std::true_type
+{
+};
+
+// Returns the size of T's binary representation if it's the same for all
+// values of T, 0 otherwise
+template <typename T>
+constexpr std::size_t fixed_binary_size() noexcept
+{
+    if constexpr (is_trivially_serializable_v<T>)
+        return sizeof(T);
+    else if constexpr (is_reflectable_v<T>)
+        return is_packed_reflectable_candidate<T>() ? sizeof(T) : 0;
+    else if constexpr (is_std_array<T>::value)
+        return fixed_binary_size<typename T::value_type>() *
+               std::tuple_size_v<T>;
+    else
+        return 0;
+}
+} // namespace detail
+
+template <typename T>
+inline constexpr bool has_fixed_binary_size_v =
+    detail::fixed_binary_size<T>() != 0;
+
+// Size of the binary representation of any value of T, for types with
+// has_fixed_binary_size_v<T>, i.e.:
+//   std::array<std::byte, kl::binary_size<header>()> buffer;
+template <typename T>
+constexpr std::size_t binary_size() noexcept
+{
+    static_assert(has_fixed_binary_size_v<T>,
+                  "T's binary size depends on its value");
+    return detail::fixed_binary_size<T>();
+}
+
+// Returns how many bytes `w << value` would write. Goes through the same
+// write_binary overloads with a counting_binary_writer, except for fixed-size
+// types where it's known up front.
+template <typename T>
+constexpr std::size_t binary_size(
+    const T& value, length_format format = length_format::fixed32)
+{
+    if constexpr (has_fixed_binary_size_v<T>)
+    {
+        (void)value;
+        (void)format;
+        return binary_size<T>();
+    }
+    else
+    {
+        counting_binary_writer w;
+        w.set_prefix_format(format);
+        w << value;
+        return w.size();
+    }
+}
+
+// Serializes the value to a buffer of the exact size, allocated once
+template <typename T>
+std::vector<std::byte> serialize_to_vector(
+    const T& value, length_format format = length_format::fixed32)
+{
+    std::vector<std::byte> ret(binary_size(value, format));
+    binary_writer w{ret};
+    w.set_prefix_format(format);
+    w << value;
+    assert(!w.err() && w.empty());
+    return ret;
+}
+} // namespace kl
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "kl/binary_rw.hpp"
+#include "kl/binary_rw/reflectable.hpp"
+#include "kl/ctti.hpp"
+#include "kl/type_traits.hpp"
+
+#include <gsl/span>
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace kl {
+
+namespace detail {
+
+// Field at given offset from the start of the record. Offsets are taken from
+// one record and are the same for all of them.
+template <typename Field, typename T>
+const Field& field_at(const T& record, std::size_t offset) noexcept
+{
+    return *reinterpret_cast<const Field*>(
+        reinterpret_cast<const char*>(&record) + offset);
+}
+
+template <typename Field, typename T>
+Field& field_at(T& record, std::size_t offset) noexcept
+{
+    return *reinterpret_cast<Field*>(reinterpret_cast<char*>(&record) +
+                                     offset);
+}
+
+template <typename T>
+std::size_t field_offset(const T& record, const void* field) noexcept
+{
+    return static_cast<std::size_t>(static_cast<const char*>(field) -
+                                    reinterpret_cast<const char*>(&record));
+}
+
+template <typename Field>
+inline constexpr std::size_t column_chunk_size =
+    (std::max)(std::size_t{1}, 4096 / sizeof(Field));
+
+template <typename Field, typename T>
+void write_column(binary_writer& w, const std::vector<T>& vec,
+                  std::size_t offset)
+{
+    if constexpr (is_trivially_serializable_v<Field>)
+    {
+        // Gather the field into a chunk and write it as one block
+        constexpr auto chunk_size = column_chunk_size<Field>;
+        Field chunk[chunk_size];
+
+        for (std::size_t i = 0; i < vec.size() && !w.err(); i += chunk_size)
+        {
+            const auto count = (std::min)(chunk_size, vec.size() - i);
+            for (std::size_t j = 0; j < count; ++j)
+                chunk[j] = field_at<Field>(vec[i + j], offset);
+            w.copy_span(gsl::span<const Field>{chunk, count});
+        }
+    }
+    else
+    {
+        for (const auto& record : vec)
+            w << field_at<Field>(record, offset);
+    }
+}
+
+// Reads `size` values of the field, appending records to `vec` as they arrive
+// when it's still shorter (the first column) so a forged length doesn't
+// allocate more than the data that's actually there
+template <typename Field, typename T>
+void read_column(binary_reader& r, std::vector<T>& vec, std::size_t size,
+                 std::size_t offset)
+{
+    if constexpr (is_trivially_serializable_v<Field>)
+    {
+        constexpr auto chunk_size = column_chunk_size<Field>;
+        Field chunk[chunk_size];
+
+        for (std::size_t i = 0; i < size; i += chunk_size)
+        {
+            const auto count = (std::min)(chunk_size, size - i);
+            if (!r.read_span(gsl::span<Field>{chunk, count}))
+                return;
+            if (vec.size() < i + count)
+                vec.resize(i + count);
+            for (std::size_t j = 0; j < count; ++j)
+                field_at<Field>(vec[i + j], offset) = chunk[j];
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            if (vec.size() == i)
+                vec.emplace_back();
+            r >> field_at<Field>(vec[i], offset);
+            if (r.err())
+                return;
+        }
+    }
+}
+} // namespace detail
+
+/*
+ * Writes a vector of reflectable records column by column (struct of arrays):
+ * the length prefix and then all values of the first field, all values of the
+ * second one and so on. Columns of trivially serializable types are written
+ * as contiguous blocks of raw values which compress much better than
+ * interleaved records and are read back with a memcpy per chunk. Other fields
+ * (strings, nested vectors or structs) are written value by value.
+ *
+ * Not compatible with the default encoding of std::vector, use kl::columnar
+ * for fields or write_columnar/read_columnar on both ends.
+ */
+template <typename T>
+void write_columnar(binary_writer& w, const std::vector<T>& vec)
+{
+    static_assert(is_reflectable_v<T>, "T must be a reflectable type");
+
+    write_length(w, vec.size());
+    if (vec.empty())
+        return;
+
+    const auto& first = vec.front();
+    ctti::reflect(first, [&](const auto& field, auto) {
+        using field_type = remove_cvref_t<decltype(field)>;
+        detail::write_column<field_type>(w, vec,
+                                         detail::field_offset(first, &field));
+    });
+}
+
+// Reads what write_columnar wrote. T must be default constructible, records
+// are created first and their fields assigned column by column. On error the
+// vector is left empty.
+template <typename T>
+void read_columnar(binary_reader& r, std::vector<T>& vec)
+{
+    static_assert(is_reflectable_v<T>, "T must be a reflectable type");
+
+    const auto size = read_count<T>(r);
+
+    vec.clear();
+    if (r.err() || !size)
+        return;
+
+    // Records are created while the first column is read, offsets are taken
+    // from a local one
+    vec.reserve(initial_capacity<T>(r, size));
+    const T sample{};
+    ctti::reflect(sample, [&](const auto& field, auto) {
+        using field_type = remove_cvref_t<decltype(field)>;
+        if (!r.err())
+        {
+            detail::read_column<field_type>(
+                r, vec, size, detail::field_offset(sample, &field));
+        }
+    });
+
+    if (r.err())
+        vec.clear();
+    else
+        vec.resize(size); // Only for records without fields
+}
+
+/*
+ * std::vector of reflectable records encoded with write_columnar, i.e. for
+ * batches of telemetry samples:
+
+    struct batch
+    {
+        std::uint64_t id;
+        kl::columnar<std::vector<sample>> samples;
+    };
+    KL_REFLECT_STRUCT(batch, id, samples)
+ */
+template <typename Container>
+class columnar;
+
+template <typename T>
+class columnar<std::vector<T>>
+{
+    static_assert(is_reflectable_v<T>, "T must be a reflectable type");
+
+public:
+    using value_type = std::vector<T>;
+
+    columnar() = default;
+    columnar(std::vector<T> value) : value_{std::move(value)} {}
+
+    std::vector<T>& value() noexcept { return value_; }
+    const std::vector<T>& value() const noexcept { return value_; }
+
+private:
+    std::vector<T> value_;
+};
+
+template <typename T>
+void write_binary(binary_writer& w, const columnar<std::vector<T>>& value)
+{
+    write_columnar(w, value.value());
+}
+
+template <typename T>
+void read_binary(binary_reader& r, columnar<std::vector<T>>& value)
+{
+    read_columnar(r, value.value());
+}
+} // namespace kl
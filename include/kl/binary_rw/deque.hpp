@@ -0,0 +1,34 @@
+#pragma once
+
+#include "kl/binary_rw.hpp"
+
+#include <deque>
+
+namespace kl {
+
+template <typename T, typename Alloc>
+void write_binary(kl::binary_writer& w, const std::deque<T, Alloc>& deq)
+{
+    write_length(w, deq.size());
+
+    for (const auto& item : deq)
+        w << item;
+}
+
+template <typename T, typename Alloc>
+void read_binary(kl::binary_reader& r, std::deque<T, Alloc>& deq)
+{
+    const auto size = read_count<T>(r);
+    deq.clear();
+
+    for (std::uint32_t i = 0; i < size; ++i)
+    {
+        deq.push_back(r.read<T>());
+        if (r.err())
+        {
+            deq.clear();
+            break;
+        }
+    }
+}
+} // namespace kl
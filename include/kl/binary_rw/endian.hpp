@@ -3,9 +3,24 @@
 #include "kl/binary_rw.hpp"
 
 #include <boost/endian/arithmetic.hpp>
+#include <gsl/span>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 
 namespace kl {
 
+template <boost::endian::order Order, typename T, std::size_t n_bits,
+          boost::endian::align Align>
+struct is_trivially_serializable<
+    boost::endian::endian_arithmetic<Order, T, n_bits, Align>>
+    : std::true_type
+{
+};
+
 template <boost::endian::order Order, typename T, std::size_t n_bits,
           boost::endian::align Align>
 void write_binary(
@@ -23,4 +38,90 @@ void read_binary(
 {
     r.read_raw(value);
 }
+
+namespace detail {
+
+// Reverses bytes of each element in place. Uses SSSE3/AVX2 when the CPU has
+// them (x86 with GCC or Clang), plain loop otherwise.
+void byte_swap(std::uint16_t* data, std::size_t count) noexcept;
+void byte_swap(std::uint32_t* data, std::size_t count) noexcept;
+void byte_swap(std::uint64_t* data, std::size_t count) noexcept;
+
+template <typename T>
+using byte_swap_type = std::conditional_t<
+    sizeof(T) == 2, std::uint16_t,
+    std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>;
+
+template <typename T>
+void byte_swap(T* data, std::size_t count) noexcept
+{
+    static_assert(sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+    // Signed integers may be accessed through their unsigned counterparts
+    byte_swap(reinterpret_cast<byte_swap_type<T>*>(data), count);
+}
+
+template <boost::endian::order Order, typename T>
+inline constexpr bool needs_byte_swap =
+    Order != boost::endian::order::native && sizeof(T) > 1;
+} // namespace detail
+
+/*
+ * Bulk conversion between native integers and their wire representation in
+ * given byte order, i.e. for big-endian sample frames:
+
+    std::vector<std::int16_t> samples = ...;
+    kl::write_length(w, samples.size());
+    kl::write_endian<boost::endian::order::big>(w, gsl::span{samples});
+    ...
+    samples.resize(kl::read_count<std::int16_t>(r));
+    kl::read_endian<boost::endian::order::big>(r, gsl::span{samples});
+
+ * Data is copied as a block and byte-swapped (if needed) in bulk. That's much
+ * faster than going through std::vector<boost::endian::big_int16_t> which
+ * swaps each element on access. No length prefix is written or read.
+ */
+template <boost::endian::order Order, typename T, std::size_t Extent>
+void write_endian(binary_writer& w, gsl::span<const T, Extent> span) noexcept
+{
+    static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>,
+                  "T must be an integer type");
+
+    if constexpr (!detail::needs_byte_swap<Order, T>)
+    {
+        w.write_span(span);
+    }
+    else
+    {
+        // Swap a copy, a chunk at a time
+        constexpr std::size_t chunk_size = 4096 / sizeof(T);
+        T chunk[chunk_size];
+
+        for (std::size_t i = 0; i < span.size() && !w.err(); i += chunk_size)
+        {
+            const auto count = (std::min)(chunk_size, span.size() - i);
+            std::memcpy(chunk, span.data() + i, count * sizeof(T));
+            detail::byte_swap(chunk, count);
+            w.copy_span(gsl::span<const T>{chunk, count});
+        }
+    }
+}
+
+template <boost::endian::order Order, typename T, std::size_t Extent>
+void write_endian(binary_writer& w, gsl::span<T, Extent> span) noexcept
+{
+    write_endian<Order>(w, gsl::span<const T, Extent>{span});
+}
+
+template <boost::endian::order Order, typename T, std::size_t Extent>
+void read_endian(binary_reader& r, gsl::span<T, Extent> span) noexcept
+{
+    static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>,
+                  "T must be an integer type");
+    static_assert(!std::is_const_v<T>, "Can't read into a span of const T");
+
+    if (!r.read_span(span))
+        return;
+    if constexpr (detail::needs_byte_swap<Order, T>)
+        detail::byte_swap(span.data(), span.size());
+}
 } // namespace kl
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "kl/binary_rw.hpp"
+
+#include <boost/container/flat_map.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace kl {
+
+// Same format as std::map
+template <typename K, typename V, typename Compare, typename Alloc>
+void write_binary(kl::binary_writer& w,
+                  const boost::container::flat_map<K, V, Compare, Alloc>& map)
+{
+    write_length(w, map.size());
+
+    for (const auto& kv : map)
+    {
+        w << kv.first;
+        w << kv.second;
+    }
+}
+
+// Reads all the elements to the underlying sequence first and adopts it as a
+// whole. Data written from a map is already sorted so it's only verified, the
+// sequence is sorted (and deduplicated) only if needed. Of duplicated keys the
+// first one read is kept, like std::map does.
+template <typename K, typename V, typename Compare, typename Alloc>
+void read_binary(kl::binary_reader& r,
+                 boost::container::flat_map<K, V, Compare, Alloc>& map)
+{
+    const auto size = read_count<std::pair<K, V>>(r);
+    map.clear();
+
+    auto seq = map.extract_sequence();
+    seq.clear();
+    seq.reserve(initial_capacity<std::pair<K, V>>(r, size));
+
+    for (std::uint32_t i = 0; i < size; ++i)
+    {
+        auto key = r.read<K>();
+        seq.emplace_back(std::move(key), r.read<V>());
+        if (r.err())
+            return;
+    }
+
+    const auto comp = map.key_comp();
+    const auto ordered_unique =
+        std::adjacent_find(seq.begin(), seq.end(),
+                           [&](const auto& a, const auto& b) {
+                               return !comp(a.first, b.first);
+                           }) == seq.end();
+
+    if (!ordered_unique)
+    {
+        std::stable_sort(seq.begin(), seq.end(),
+                         [&](const auto& a, const auto& b) {
+                             return comp(a.first, b.first);
+                         });
+        seq.erase(std::unique(seq.begin(), seq.end(),
+                              [&](const auto& a, const auto& b) {
+                                  return !comp(a.first, b.first);
+                              }),
+                  seq.end());
+    }
+    map.adopt_sequence(boost::container::ordered_unique_range,
+                       std::move(seq));
+}
+} // namespace kl
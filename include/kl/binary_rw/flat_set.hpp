@@ -0,0 +1,62 @@
+#pragma once
+
+#include "kl/binary_rw.hpp"
+
+#include <boost/container/flat_set.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace kl {
+
+// Same format as std::set
+template <typename T, typename Compare, typename Alloc>
+void write_binary(kl::binary_writer& w,
+                  const boost::container::flat_set<T, Compare, Alloc>& set)
+{
+    write_length(w, set.size());
+
+    for (const auto& key : set)
+        w << key;
+}
+
+// Like flat_map, adopts the sequence as a whole and sorts it only if needed,
+// keeping the first of equivalent elements
+template <typename T, typename Compare, typename Alloc>
+void read_binary(kl::binary_reader& r,
+                 boost::container::flat_set<T, Compare, Alloc>& set)
+{
+    const auto size = read_count<T>(r);
+    set.clear();
+
+    auto seq = set.extract_sequence();
+    seq.clear();
+    seq.reserve(initial_capacity<T>(r, size));
+
+    for (std::uint32_t i = 0; i < size; ++i)
+    {
+        seq.push_back(r.read<T>());
+        if (r.err())
+            return;
+    }
+
+    const auto comp = set.key_comp();
+    const auto ordered_unique =
+        std::adjacent_find(seq.begin(), seq.end(),
+                           [&](const auto& a, const auto& b) {
+                               return !comp(a, b);
+                           }) == seq.end();
+
+    if (!ordered_unique)
+    {
+        std::stable_sort(seq.begin(), seq.end(), comp);
+        seq.erase(std::unique(seq.begin(), seq.end(),
+                              [&](const auto& a, const auto& b) {
+                                  return !comp(a, b);
+                              }),
+                  seq.end());
+    }
+    set.adopt_sequence(boost::container::ordered_unique_range,
+                       std::move(seq));
+}
+} // namespace kl
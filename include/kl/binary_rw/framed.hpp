@@ -0,0 +1,198 @@
+#pragma once
+
+#include "kl/binary_rw.hpp"
+#include "kl/binary_rw/growable_writer.hpp"
+#include "kl/crc32c.hpp"
+
+#include <gsl/span>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace kl {
+
+// Precedes each message written by framed_writer: size of the message and
+// CRC32C of its bytes, both in native byte order
+struct frame_header
+{
+    std::uint32_t size;
+    std::uint32_t checksum;
+};
+
+/*
+ * Writes messages to a binary_writer (i.e. a socket buffer or a file) as
+ * frames, each prefixed with a frame_header:
+
+    kl::framed_writer fw{out};
+    fw.write(request);
+
+    auto& w = fw.begin();   // or field by field
+    w << id << payload;
+    fw.commit();
+
+ * A message is serialized to an internal growable_binary_writer first so its
+ * size and checksum are known before the header goes out. Blocks are reused
+ * from one message to the next.
+ */
+class framed_writer
+{
+public:
+    explicit framed_writer(binary_writer& w, std::size_t block_size = 4096)
+        : w_{w}, scratch_{block_size}
+    {
+    }
+
+    framed_writer(const framed_writer&) = delete;
+    framed_writer& operator=(const framed_writer&) = delete;
+
+    // Starts a new message, discarding one that wasn't committed
+    binary_writer& begin() noexcept
+    {
+        scratch_.clear();
+        scratch_.set_prefix_format(w_.prefix_format());
+        return scratch_;
+    }
+
+    // Writes the message started with begin() to the underlying writer. Sets
+    // its err() if the message couldn't be serialized.
+    bool commit()
+    {
+        if (scratch_.err() ||
+            scratch_.size() > (std::numeric_limits<std::uint32_t>::max)())
+        {
+            w_.notify_error();
+            return false;
+        }
+
+        const auto segments = scratch_.segments();
+        frame_header header{static_cast<std::uint32_t>(scratch_.size()), 0};
+        for (const auto& segment : segments)
+            header.checksum = crc32c(header.checksum, segment);
+
+        w_.write_raw(header);
+        // Copied, the blocks are reused for the next message
+        for (const auto& segment : segments)
+            w_.copy_span(segment);
+        return !w_.err();
+    }
+
+    template <typename T>
+    bool write(const T& message)
+    {
+        begin() << message;
+        return commit();
+    }
+
+private:
+    binary_writer& w_;
+    growable_binary_writer scratch_;
+};
+
+/*
+ * Reads frames written by framed_writer, verifying their checksums:
+
+    kl::framed_reader fr{in};
+    request req;
+    while (fr.read(req))
+        ...
+    if (fr.checksum_error())
+        ...
+
+ * Frames are verified and decoded in place when the underlying reader has
+ * them buffered, otherwise they are read to an internal buffer first. Frames
+ * claiming more than `max_frame_size` bytes are rejected before anything is
+ * allocated for them. Any error is reported through the underlying reader's
+ * err().
+ */
+class framed_reader
+{
+public:
+    static constexpr std::size_t default_max_frame_size = 16 * 1024 * 1024;
+
+    explicit framed_reader(binary_reader& r,
+                           std::size_t max_frame_size = default_max_frame_size)
+        : r_{r}, max_frame_size_{max_frame_size}
+    {
+    }
+
+    framed_reader(const framed_reader&) = delete;
+    framed_reader& operator=(const framed_reader&) = delete;
+
+    // Reads the next frame and returns a reader over its verified contents,
+    // valid until the next call. Returns nothing if the frame is truncated,
+    // corrupted or bigger than max_frame_size or the reader's allocation
+    // budget.
+    std::optional<binary_reader> next()
+    {
+        frame_header header;
+        if (!r_.read_raw(header))
+            return std::nullopt;
+        if (header.size > max_frame_size_ || header.size > r_.max_left())
+        {
+            r_.notify_error();
+            return std::nullopt;
+        }
+
+        gsl::span<const std::byte> payload;
+        if (r_.left() >= header.size)
+        {
+            payload = r_.span(header.size);
+        }
+        else
+        {
+            // Transient, checked against the budget but not charged
+            if (header.size > r_.alloc_budget())
+            {
+                r_.notify_error();
+                return std::nullopt;
+            }
+            buffer_.resize(header.size);
+            if (!r_.read_span(gsl::span<std::byte>{buffer_}))
+                return std::nullopt;
+            payload = buffer_;
+        }
+
+        if (crc32c(payload) != header.checksum)
+        {
+            checksum_error_ = true;
+            r_.notify_error();
+            return std::nullopt;
+        }
+
+        binary_reader ret{payload};
+        ret.set_prefix_format(r_.prefix_format());
+        ret.set_alloc_budget(r_.alloc_budget());
+        return ret;
+    }
+
+    // Reads the next frame to `message` which must take the whole frame
+    template <typename T>
+    bool read(T& message)
+    {
+        auto frame = next();
+        if (!frame)
+            return false;
+
+        *frame >> message;
+        if (frame->err() || !frame->empty() ||
+            !r_.charge_alloc(r_.alloc_budget() - frame->alloc_budget()))
+        {
+            r_.notify_error();
+            return false;
+        }
+        return true;
+    }
+
+    // True if reading stopped at a frame whose checksum doesn't match
+    bool checksum_error() const noexcept { return checksum_error_; }
+
+private:
+    binary_reader& r_;
+    std::size_t max_frame_size_;
+    std::vector<std::byte> buffer_;
+    bool checksum_error_{false};
+};
+} // namespace kl
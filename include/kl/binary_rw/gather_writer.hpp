@@ -0,0 +1,126 @@
+#pragma once
+
+#include "kl/binary_rw.hpp"
+#include "kl/binary_rw/growable_writer.hpp"
+
+#include <gsl/span>
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace kl {
+
+/*
+ * binary_writer for vectored writes of messages carrying big payloads (images,
+ * blobs). Small fields are copied to blocks from a binary_block_pool like in
+ * growable_binary_writer, but spans of at least `threshold` bytes passed to
+ * write_span (i.e. the contents of a std::vector<std::uint8_t> or a string)
+ * are only referenced. The output is a list of segments alternating between
+ * the two, ready for writev/WSASend:
+
+    kl::gather_binary_writer w;
+    w << header << frame.pixels << footer;
+
+    std::vector<iovec> iov;
+    for (auto segment : w.segments())
+        iov.push_back({const_cast<std::byte*>(segment.data()), segment.size()});
+    ::writev(fd, iov.data(), static_cast<int>(iov.size()));
+
+ * Referenced data isn't copied anywhere so it must stay alive and unchanged
+ * until the segments are consumed.
+ *
+ * Note that pos(), left() and skip() refer to the current block only, the
+ * total number of bytes written is returned by size().
+ */
+class gather_binary_writer final : public detail::block_chain_writer
+{
+public:
+    // Uses its own pool with blocks of given size
+    explicit gather_binary_writer(std::size_t threshold = 1024,
+                                  std::size_t block_size = 4096)
+        : block_chain_writer{block_size}
+    {
+        reference_threshold_ = (std::max)(threshold, std::size_t{1});
+    }
+
+    explicit gather_binary_writer(binary_block_pool& pool,
+                                  std::size_t threshold = 1024)
+        : block_chain_writer{pool}
+    {
+        reference_threshold_ = (std::max)(threshold, std::size_t{1});
+    }
+
+    std::size_t threshold() const noexcept { return reference_threshold_; }
+
+    // Returns the total number of bytes written, copied or referenced
+    std::size_t size() const noexcept { return size_ + (pos_ - mark_); }
+
+    // Returns views of the written data in order. They stay valid until the
+    // next write or clear() (and as long as the referenced data does).
+    std::vector<gsl::span<const std::byte>> segments() const
+    {
+        auto ret = segments_;
+        if (pos_ > mark_)
+            ret.emplace_back(buffer_.data() + mark_, pos_ - mark_);
+        return ret;
+    }
+
+    // Copies the written data to one contiguous buffer
+    std::vector<std::byte> finalize() const
+    {
+        return join_segments(*this);
+    }
+
+    // Returns all the blocks to the pool, forgets the referenced data and
+    // resets the writer (including the error state)
+    void clear() noexcept
+    {
+        release_blocks();
+        segments_.clear();
+        mark_ = 0;
+        size_ = 0;
+    }
+
+protected:
+    bool reference(const std::byte* data, std::size_t size) noexcept override
+    {
+        try
+        {
+            close_segment();
+            segments_.emplace_back(data, size);
+            size_ += size;
+            return true;
+        }
+        catch (const std::bad_alloc&)
+        {
+            err_ = true;
+            return false;
+        }
+    }
+
+    void leave_block() override
+    {
+        close_segment();
+        mark_ = 0; // Where the next block starts
+    }
+
+private:
+    // Ends the segment of bytes copied to the current block since the last
+    // reference, further writes to the block start a new one
+    void close_segment()
+    {
+        if (pos_ == mark_)
+            return;
+        segments_.emplace_back(buffer_.data() + mark_, pos_ - mark_);
+        size_ += pos_ - mark_;
+        mark_ = pos_;
+    }
+
+private:
+    std::vector<gsl::span<const std::byte>> segments_;
+    std::size_t mark_{0}; // Start of the current segment in the block
+    std::size_t size_{0}; // Bytes in segments_
+};
+} // namespace kl
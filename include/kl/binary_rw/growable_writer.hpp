@@ -0,0 +1,222 @@
+#pragma once
+
+#include "kl/binary_rw.hpp"
+
+#include <gsl/span>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <optional>
+#include <vector>
+
+namespace kl {
+
+// Pool of equally sized memory blocks backing growable_binary_writer. Blocks
+// of finished messages go back to the free list and are handed out again for
+// the next ones. Not thread-safe, use one per thread.
+class binary_block_pool
+{
+public:
+    using block_ptr = std::unique_ptr<std::byte[]>;
+
+    explicit binary_block_pool(std::size_t block_size = 4096)
+        : block_size_{(std::max)(block_size, std::size_t{16})}
+    {
+    }
+
+    binary_block_pool(const binary_block_pool&) = delete;
+    binary_block_pool& operator=(const binary_block_pool&) = delete;
+
+    std::size_t block_size() const noexcept { return block_size_; }
+    std::size_t num_free() const noexcept { return free_.size(); }
+
+    block_ptr acquire()
+    {
+        if (free_.empty())
+            return block_ptr{new std::byte[block_size_]};
+
+        auto block = std::move(free_.back());
+        free_.pop_back();
+        return block;
+    }
+
+    void release(block_ptr block) noexcept
+    {
+        try
+        {
+            free_.push_back(std::move(block));
+        }
+        catch (const std::bad_alloc&)
+        {
+            // Just let the block go
+        }
+    }
+
+    // Frees all the blocks on the free list
+    void shrink() noexcept { free_.clear(); }
+
+private:
+    std::size_t block_size_;
+    std::vector<block_ptr> free_;
+};
+
+namespace detail {
+
+// Common part of growable_binary_writer and gather_binary_writer: writes that
+// don't fit in the current block continue in a new one from the pool
+class block_chain_writer : public binary_writer
+{
+public:
+    block_chain_writer(const block_chain_writer&) = delete;
+    block_chain_writer& operator=(const block_chain_writer&) = delete;
+
+protected:
+    // Uses its own pool with blocks of given size
+    explicit block_chain_writer(std::size_t block_size)
+        : binary_writer{gsl::span<std::byte>{}},
+          own_pool_{std::in_place, block_size},
+          pool_{&*own_pool_}
+    {
+    }
+
+    explicit block_chain_writer(binary_block_pool& pool)
+        : binary_writer{gsl::span<std::byte>{}}, pool_{&pool}
+    {
+    }
+
+    ~block_chain_writer() { release_blocks(); }
+
+    bool overflow(const std::byte* data, std::size_t size) noexcept override
+    {
+        try
+        {
+            for (;;)
+            {
+                const auto chunk = (std::min)(size, left());
+                if (chunk > 0)
+                {
+                    std::memcpy(cursor(), data, chunk);
+                    pos_ += chunk;
+                    data += chunk;
+                    size -= chunk;
+                }
+                if (size == 0)
+                    return true;
+
+                // Reserve the slot first so a failure leaves nothing behind
+                blocks_.emplace_back();
+                blocks_.back() = pool_->acquire();
+                leave_block();
+                buffer_ = {blocks_.back().get(), pool_->block_size()};
+                pos_ = 0;
+            }
+        }
+        catch (const std::bad_alloc&)
+        {
+            if (!blocks_.empty() && !blocks_.back())
+                blocks_.pop_back();
+            err_ = true;
+            return false;
+        }
+    }
+
+    // Called once the next block is acquired, right before writing moves on
+    // to it. The writer is left in the error state if it throws
+    // std::bad_alloc.
+    virtual void leave_block() {}
+
+    // Copies segments of the derived writer to one contiguous buffer
+    template <typename Writer>
+    static std::vector<std::byte> join_segments(const Writer& w)
+    {
+        std::vector<std::byte> ret(w.size());
+        auto* out = ret.data();
+        for (const auto& segment : w.segments())
+        {
+            std::memcpy(out, segment.data(), segment.size());
+            out += segment.size();
+        }
+        return ret;
+    }
+
+    // Returns all the blocks to the pool and resets the cursor and the error
+    // state
+    void release_blocks() noexcept
+    {
+        for (auto& block : blocks_)
+            pool_->release(std::move(block));
+        blocks_.clear();
+        buffer_ = {};
+        pos_ = 0;
+        err_ = false;
+    }
+
+protected:
+    std::optional<binary_block_pool> own_pool_;
+    binary_block_pool* pool_;
+    std::vector<binary_block_pool::block_ptr> blocks_;
+};
+} // namespace detail
+
+/*
+ * binary_writer which never runs out of space. Data is written to a chain of
+ * blocks taken from a binary_block_pool so all the existing write_binary
+ * overloads work unchanged and nothing gets copied on growth. Use segments()
+ * to pass the data to a vectored write (writev/WSASend) without copying it or
+ * finalize() to get it in one piece.
+ *
+ * Note that pos(), left() and skip() refer to the current block only, the
+ * total number of bytes written is returned by size().
+ */
+class growable_binary_writer final : public detail::block_chain_writer
+{
+public:
+    // Uses its own pool with blocks of given size
+    explicit growable_binary_writer(std::size_t block_size = 4096)
+        : block_chain_writer{block_size}
+    {
+    }
+
+    explicit growable_binary_writer(binary_block_pool& pool)
+        : block_chain_writer{pool}
+    {
+    }
+
+    // Returns the total number of bytes written
+    std::size_t size() const noexcept
+    {
+        return blocks_.empty()
+                   ? 0
+                   : (blocks_.size() - 1) * pool_->block_size() + pos_;
+    }
+
+    // Returns views of the written data in order. They stay valid until the
+    // next write or clear().
+    std::vector<gsl::span<const std::byte>> segments() const
+    {
+        std::vector<gsl::span<const std::byte>> ret;
+        ret.reserve(blocks_.size());
+        for (std::size_t i = 0; i < blocks_.size(); ++i)
+        {
+            const auto length =
+                i + 1 < blocks_.size() ? pool_->block_size() : pos_;
+            if (length > 0)
+                ret.emplace_back(blocks_[i].get(), length);
+        }
+        return ret;
+    }
+
+    // Copies the written data to one contiguous buffer
+    std::vector<std::byte> finalize() const
+    {
+        return join_segments(*this);
+    }
+
+    // Returns all the blocks to the pool and resets the writer (including the
+    // error state) so it can be used for the next message
+    void clear() noexcept { release_blocks(); }
+};
+} // namespace kl
@@ -3,13 +3,14 @@
 #include "kl/binary_rw.hpp"
 
 #include <map>
+#include <utility>
 
 namespace kl {
 
 template <typename K, typename V>
 void write_binary(kl::binary_writer& w, const std::map<K, V>& map)
 {
-    w << static_cast<std::uint32_t>(map.size());
+    write_length(w, map.size());
 
     for (const auto& kv : map)
     {
@@ -18,20 +19,30 @@ void write_binary(kl::binary_writer& w, const std::map<K, V>& map)
     }
 }
 
+// write_binary emits keys in order so each one normally goes right at the end,
+// which with a hint is amortized O(1) instead of O(log n). Keys out of order
+// (data not written from std::map) take the regular path.
 template <typename K, typename V>
 void read_binary(kl::binary_reader& r, std::map<K, V>& map)
 {
-    const auto size = r.read<std::uint32_t>();
+    const auto size = read_count<std::pair<K, V>>(r);
     map.clear();
 
+    const auto comp = map.key_comp();
     for (std::uint32_t i = 0; i < size; ++i)
     {
-        map.insert({r.read<K>(), r.read<V>()});
+        auto key = r.read<K>();
+        auto value = r.read<V>();
         if (r.err())
         {
             map.clear();
             break;
         }
+
+        if (map.empty() || comp(map.rbegin()->first, key))
+            map.emplace_hint(map.end(), std::move(key), std::move(value));
+        else
+            map.emplace(std::move(key), std::move(value));
     }
 }
 } // namespace kl
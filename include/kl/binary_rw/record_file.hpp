@@ -0,0 +1,259 @@
+#pragma once
+
+#include "kl/binary_rw.hpp"
+#include "kl/binary_rw/growable_writer.hpp"
+#include "kl/file_view.hpp"
+#include "kl/iterator_facade.hpp"
+
+#include <gsl/span>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Append-only file of records encoded with binary_rw, with random access by
+ * record number. Layout (all integers in native byte order):
+
+    header   magic, version, length_format the records were written with
+    records  [uint32 size][uint32 crc32c of payload][payload] ...
+    index    uint64 offset of each record, in order
+    footer   uint64 index offset, uint64 record count, uint32 crc32c of the
+             index, uint32 magic
+
+ * The index and footer are written when the writer is closed. A file whose
+ * writer didn't finish (no valid footer) is rejected by record_file.
+ */
+
+namespace kl {
+
+struct record_file_error : std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
+
+namespace detail {
+
+struct record_file_header
+{
+    std::uint32_t magic;
+    std::uint8_t version;
+    std::uint8_t format;
+    std::uint16_t reserved;
+};
+
+struct record_header
+{
+    std::uint32_t size;
+    std::uint32_t checksum;
+};
+
+struct record_file_footer
+{
+    std::uint64_t index_offset;
+    std::uint64_t count;
+    std::uint32_t index_checksum;
+    std::uint32_t magic;
+};
+
+inline constexpr std::uint32_t record_file_magic = 0x46524c4b;  // KLRF
+inline constexpr std::uint32_t record_index_magic = 0x49524c4b; // KLRI
+inline constexpr std::uint8_t record_file_version = 1;
+} // namespace detail
+
+/*
+ * Writes records produced by write_binary:
+
+    kl::record_file_writer writer{"events.bin"};
+    for (const auto& ev : events)
+        writer.append(ev);
+    writer.close();
+
+ * Each record is serialized to a reusable growable_binary_writer and written
+ * out with its size and checksum. Offsets of the records are kept in memory
+ * (8 bytes per record) until close() writes them out as the index.
+ * Throws std::system_error on I/O errors.
+ */
+class record_file_writer
+{
+public:
+    explicit record_file_writer(const char* file_path,
+                                length_format format = length_format::fixed32);
+    // Closes the file if close() wasn't called, ignoring any errors
+    ~record_file_writer();
+
+    record_file_writer(const record_file_writer&) = delete;
+    record_file_writer& operator=(const record_file_writer&) = delete;
+
+    template <typename T>
+    void append(const T& value)
+    {
+        scratch_.clear();
+        scratch_.set_prefix_format(format_);
+        scratch_ << value;
+        if (scratch_.err())
+            throw record_file_error{"can't serialize the record"};
+        append_segments(scratch_.segments());
+    }
+
+    // Appends already serialized record
+    void append_bytes(gsl::span<const std::byte> record)
+    {
+        append_segments({record});
+    }
+
+    // Number of records appended so far
+    std::size_t size() const noexcept { return offsets_.size(); }
+
+    // Writes the index and the footer and closes the file
+    void close();
+
+private:
+    void append_segments(const std::vector<gsl::span<const std::byte>>& data);
+    void write(std::FILE* file, const void* data, std::size_t size);
+
+private:
+    struct file_closer
+    {
+        void operator()(std::FILE* file) const noexcept { std::fclose(file); }
+    };
+
+    std::unique_ptr<std::FILE, file_closer> file_;
+    length_format format_;
+    std::uint64_t offset_{0};
+    std::vector<std::uint64_t> offsets_;
+    growable_binary_writer scratch_;
+};
+
+/*
+ * Read-only view of a file written by record_file_writer. The file is mapped
+ * and records are decoded straight from the mapped bytes:
+
+    kl::record_file file{"events.bin"};
+    auto ev = file.read<event>(n);    // O(1) access to n-th record
+
+    for (auto rec : file)             // or all of them, in order
+    {
+        auto r = file.reader(rec);
+        ...
+    }
+
+ * Header, footer and the index are validated on open, each record's bounds
+ * and checksum when it's accessed. Throws record_file_error if they don't add
+ * up and std::system_error if the file can't be mapped. Contents already in
+ * memory can be opened the same way from a span of bytes.
+ */
+class record_file
+{
+public:
+    class iterator;
+
+    explicit record_file(const char* file_path);
+    // Doesn't copy the bytes, they must outlive the record_file
+    explicit record_file(gsl::span<const std::byte> bytes);
+
+    std::size_t size() const noexcept { return count_; }
+    bool empty() const noexcept { return count_ == 0; }
+
+    // Returns payload of n-th record. Throws std::out_of_range if there's no
+    // such record.
+    gsl::span<const std::byte> record(std::size_t n) const;
+    gsl::span<const std::byte> operator[](std::size_t n) const
+    {
+        return record(n);
+    }
+
+    // Returns a reader over the record's payload, set to the length format
+    // the file was written with
+    binary_reader reader(gsl::span<const std::byte> record) const noexcept
+    {
+        binary_reader r{record};
+        r.set_prefix_format(format_);
+        return r;
+    }
+
+    binary_reader reader(std::size_t n) const { return reader(record(n)); }
+
+    // Decodes n-th record, the whole payload must be consumed
+    template <typename T>
+    T read(std::size_t n) const
+    {
+        auto r = reader(n);
+        T value = r.read<T>();
+        if (r.err() || !r.empty())
+            throw record_file_error{"can't decode record " + std::to_string(n)};
+        return value;
+    }
+
+    iterator begin() const noexcept;
+    iterator end() const noexcept;
+
+private:
+    void open();
+
+private:
+    std::optional<file_view> view_;
+    gsl::span<const std::byte> bytes_;
+    const std::byte* index_{nullptr};
+    std::uint64_t index_offset_{0};
+    std::size_t count_{0};
+    length_format format_{length_format::fixed32};
+};
+
+class record_file::iterator
+    : public iterator_facade<iterator, gsl::span<const std::byte>,
+                             std::random_access_iterator_tag>
+{
+public:
+    iterator() = default;
+
+private:
+    friend class record_file;
+
+    iterator(const record_file* file, std::size_t n) noexcept
+        : file_{file}, n_{n}
+    {
+    }
+
+private:
+    const record_file* file_{nullptr};
+    std::size_t n_{0};
+
+public:
+    void advance(std::ptrdiff_t n) noexcept { n_ += n; }
+    void decrement() noexcept { --n_; }
+    void increment() noexcept { ++n_; }
+
+    std::ptrdiff_t distance_to(const iterator& other) const noexcept
+    {
+        return static_cast<std::ptrdiff_t>(other.n_) -
+               static_cast<std::ptrdiff_t>(n_);
+    }
+
+    bool equal_to(const iterator& other) const noexcept
+    {
+        return other.n_ == n_;
+    }
+
+    gsl::span<const std::byte> dereference() const
+    {
+        return file_->record(n_);
+    }
+};
+
+inline record_file::iterator record_file::begin() const noexcept
+{
+    return {this, 0};
+}
+
+inline record_file::iterator record_file::end() const noexcept
+{
+    return {this, count_};
+}
+} // namespace kl
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "kl/binary_rw.hpp"
+#include "kl/ctti.hpp"
+#include "kl/type_traits.hpp"
+
+#include <cstddef>
+#include <type_traits>
+
+namespace kl {
+namespace detail {
+
+// Lets us visit the fields of T in a constant expression without
+// constructing T. Fields are only named, never read.
+template <typename T>
+union reflect_storage
+{
+    constexpr reflect_storage() noexcept : dummy{} {}
+
+    char dummy;
+    T value;
+};
+
+template <typename T>
+constexpr bool is_packed_reflectable_candidate() noexcept;
+
+template <typename T>
+constexpr bool is_raw_serializable_field() noexcept
+{
+    if constexpr (is_trivially_serializable_v<T>)
+        return true;
+    else if constexpr (is_reflectable_v<T>)
+        return is_packed_reflectable_candidate<T>();
+    else
+        return false;
+}
+
+struct packed_size_visitor
+{
+    template <typename Field>
+    constexpr void operator()(const Field&, const char*) noexcept
+    {
+        if constexpr (is_raw_serializable_field<Field>())
+            size += sizeof(Field);
+        else
+            raw = false;
+    }
+
+    std::size_t size{0};
+    bool raw{true};
+};
+
+// True if T could be written with a single memcpy: trivially copyable,
+// standard-layout and all reflected fields (recursively) are trivially
+// serializable types whose sizes add up to sizeof(T), i.e. there's no padding
+// and no field was left out. Whether the fields are reflected in declaration
+// order is checked at runtime by has_packed_layout().
+template <typename T>
+constexpr bool is_packed_reflectable_candidate() noexcept
+{
+    if constexpr (!std::is_trivially_copyable_v<T> ||
+                  !std::is_standard_layout_v<T>)
+    {
+        return false;
+    }
+    else
+    {
+        reflect_storage<T> storage;
+        packed_size_visitor vis;
+        ctti::reflect(storage.value, vis);
+        return vis.raw && vis.size == sizeof(T);
+    }
+}
+
+template <typename T>
+bool fields_at_offsets(const T& obj, const char* base,
+                       std::size_t& offset) noexcept
+{
+    bool ret = true;
+    ctti::reflect(obj, [&](const auto& field, auto) {
+        using field_type = remove_cvref_t<decltype(field)>;
+
+        if constexpr (is_reflectable_v<field_type>)
+        {
+            ret = ret && fields_at_offsets(field, base, offset);
+        }
+        else
+        {
+            const auto* addr = reinterpret_cast<const char*>(&field);
+            ret = ret && addr == base + offset;
+            offset += sizeof(field_type);
+        }
+    });
+    return ret;
+}
+
+// Checks that the reflected fields follow each other in memory so that
+// the memcpy produces the same bytes as writing them one by one
+template <typename T>
+bool has_packed_layout(const T& obj) noexcept
+{
+    std::size_t offset = 0;
+    return fields_at_offsets(obj, reinterpret_cast<const char*>(&obj),
+                             offset) &&
+           offset == sizeof(T);
+}
+
+template <typename T>
+bool is_packed_reflectable(const T& obj) noexcept
+{
+    static_assert(is_packed_reflectable_candidate<T>());
+
+    // Same for all objects of T
+    static const bool packed = has_packed_layout(obj);
+    return packed;
+}
+} // namespace detail
+
+template <typename Reflectable>
+struct min_binary_size<Reflectable,
+                       std::enable_if_t<is_reflectable_v<Reflectable>>>
+    : std::integral_constant<
+          std::size_t,
+          detail::is_packed_reflectable_candidate<Reflectable>()
+              ? sizeof(Reflectable)
+              : (ctti::num_fields<Reflectable>() == 0 ? 0 : 1)>
+{
+};
+
+// write_binary/read_binary for all types with reflect_struct defined. Fields
+// are written one after another in the order they are reflected. If that's
+// exactly how the struct is laid out in memory (only trivially serializable
+// types, no padding, see is_packed_reflectable_candidate) the whole struct is
+// copied at once. Note that custom write_binary/read_binary for the fields'
+// types aren't used then.
+template <typename Reflectable, enable_if<is_reflectable<Reflectable>> = true>
+void write_binary(kl::binary_writer& w, const Reflectable& refl)
+{
+    if constexpr (detail::is_packed_reflectable_candidate<Reflectable>())
+    {
+        if (detail::is_packed_reflectable(refl))
+        {
+            w.write_raw(refl);
+            return;
+        }
+    }
+
+    ctti::reflect(refl, [&w](const auto& field, auto) { w << field; });
+}
+
+template <typename Reflectable, enable_if<is_reflectable<Reflectable>> = true>
+void read_binary(kl::binary_reader& r, Reflectable& refl)
+{
+    if constexpr (detail::is_packed_reflectable_candidate<Reflectable>())
+    {
+        if (detail::is_packed_reflectable(refl))
+        {
+            r.read_raw(refl);
+            return;
+        }
+    }
+
+    ctti::reflect(refl, [&r](auto& field, auto) {
+        if (!r.err())
+            r >> field;
+    });
+}
+} // namespace kl
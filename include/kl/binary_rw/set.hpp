@@ -3,32 +3,40 @@
 #include "kl/binary_rw.hpp"
 
 #include <set>
+#include <utility>
 
 namespace kl {
 
 template <typename T>
 void write_binary(kl::binary_writer& w, const std::set<T>& set)
 {
-    w << static_cast<std::uint32_t>(set.size());
+    write_length(w, set.size());
 
     for (const auto& key : set)
         w << key;
 }
 
+// Like std::map, appends at the end with a hint unless keys are out of order
 template <typename T>
 void read_binary(kl::binary_reader& r, std::set<T>& set)
 {
-    const auto size = r.read<std::uint32_t>();
+    const auto size = read_count<T>(r);
     set.clear();
 
+    const auto comp = set.key_comp();
     for (std::uint32_t i = 0; i < size; ++i)
     {
-        set.insert(r.read<T>());
+        auto key = r.read<T>();
         if (r.err())
         {
             set.clear();
             break;
         }
+
+        if (set.empty() || comp(*set.rbegin(), key))
+            set.emplace_hint(set.end(), std::move(key));
+        else
+            set.emplace(std::move(key));
     }
 }
 } // namespace kl
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "kl/binary_rw.hpp"
+
+#include <gsl/span>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iosfwd>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace kl {
+
+// Source of bytes for stream_binary_reader. Reads at most `buffer.size()`
+// bytes into the buffer and returns how many it did. 0 means the end of the
+// stream (or an error). Blocks until at least one byte is available.
+using binary_source = std::function<std::size_t(gsl::span<std::byte>)>;
+
+// Reads from a file descriptor (file, pipe, socket), retrying on EINTR
+binary_source fd_source(int fd);
+
+binary_source istream_source(std::istream& is);
+
+/*
+ * binary_reader pulling data from a binary_source on demand, i.e. to read
+ * length-prefixed records from a socket without buffering whole records first:
+
+    kl::stream_binary_reader r{kl::fd_source(sock)};
+    while (!r.at_end())
+    {
+        auto rec = r.read<record>();
+        if (r.err())
+            break;
+        ...
+    }
+
+ * Data goes through an internal buffer which is refilled when a read needs
+ * more than it holds. Reads larger than the buffer (i.e. big vectors of simple
+ * types or strings) go straight from the source to their destination.
+ * All read_binary overloads work unchanged, err() is set once a read can't be
+ * satisfied because the source ran dry.
+ *
+ * Note that pos(), left(), empty() and skip() refer to the buffered data only.
+ * Likewise, span() and peek() can't see further than the buffer size.
+ */
+class stream_binary_reader final : public binary_reader
+{
+public:
+    explicit stream_binary_reader(binary_source source,
+                                  std::size_t buffer_size = 64 * 1024)
+        : binary_reader{gsl::span<const std::byte>{}},
+          source_{std::move(source)},
+          storage_((std::max)(buffer_size, std::size_t{16}))
+    {
+        buffer_ = {storage_.data(), std::size_t{0}};
+    }
+
+    stream_binary_reader(const stream_binary_reader&) = delete;
+    stream_binary_reader& operator=(const stream_binary_reader&) = delete;
+
+    // Returns true if all the data has been read and the source is exhausted.
+    // Might block waiting for the source.
+    bool at_end() noexcept { return left() == 0 && !refill(1); }
+
+    // Unknown until the source runs dry
+    std::size_t max_left() const noexcept override
+    {
+        return eof_ ? left() : (std::numeric_limits<std::size_t>::max)();
+    }
+
+protected:
+    bool refill(std::size_t size) noexcept override
+    {
+        if (size > storage_.size())
+            return false;
+
+        // Move what's left to the front to make room for more
+        const auto buffered = left();
+        if (pos_ > 0)
+        {
+            std::memmove(storage_.data(), cursor(), buffered);
+            pos_ = 0;
+        }
+
+        auto filled = buffered;
+        while (filled < size)
+        {
+            const auto count = pull(storage_.data() + filled,
+                                    storage_.size() - filled);
+            if (count == 0)
+                break;
+            filled += count;
+        }
+
+        buffer_ = {storage_.data(), filled};
+        return filled >= size;
+    }
+
+    bool underflow(std::byte* data, std::size_t size) noexcept override
+    {
+        const auto buffered = left();
+        std::memcpy(data, cursor(), buffered);
+        pos_ += buffered;
+        data += buffered;
+        size -= buffered;
+
+        if (size < storage_.size())
+        {
+            if (!refill(size))
+            {
+                err_ = true;
+                return false;
+            }
+            std::memcpy(data, cursor(), size);
+            pos_ += size;
+            return true;
+        }
+
+        // Too big for the buffer, read it directly
+        while (size > 0)
+        {
+            const auto count = pull(data, size);
+            if (count == 0)
+            {
+                err_ = true;
+                return false;
+            }
+            data += count;
+            size -= count;
+        }
+        return true;
+    }
+
+private:
+    std::size_t pull(std::byte* data, std::size_t size) noexcept
+    {
+        if (eof_)
+            return 0;
+
+        std::size_t count = 0;
+        try
+        {
+            count = source_(gsl::span<std::byte>{data, size});
+        }
+        catch (...)
+        {
+        }
+
+        eof_ = count == 0;
+        return (std::min)(count, size);
+    }
+
+private:
+    binary_source source_;
+    std::vector<std::byte> storage_;
+    bool eof_{false};
+};
+} // namespace kl
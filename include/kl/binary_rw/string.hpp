@@ -4,30 +4,51 @@
 
 #include <gsl/span_ext>
 
-#include <vector>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace kl {
 
-void write_binary(kl::binary_writer& w, const std::string& str)
+inline void write_binary(kl::binary_writer& w, const std::string& str)
 {
-    w << static_cast<std::uint32_t>(str.size());
+    write_length(w, str.size());
 
     if (!str.empty())
         w << gsl::span<const char>{str};
 }
 
-void read_binary(kl::binary_reader& r, std::string& str)
+// Same format as std::string. Constrained so string literals don't become
+// ambiguous between the two.
+template <typename T, enable_if<std::is_same<T, std::string_view>> = true>
+void write_binary(kl::binary_writer& w, const T& str)
 {
-    const auto size = r.read<std::uint32_t>();
+    write_length(w, str.size());
+
+    if (!str.empty())
+        w << gsl::span<const char>{str.data(), str.size()};
+}
+
+inline void read_binary(kl::binary_reader& r, std::string& str)
+{
+    const auto size = read_count<char>(r);
     str.clear();
 
+    if (!detail::read_contiguous<char>(r, str, size))
+        str.clear();
+}
+
+// Doesn't copy the string, the view points into the reader's buffer. With
+// stream_binary_reader it's only valid until the next read.
+inline void read_binary(kl::binary_reader& r, std::string_view& str)
+{
+    str = {};
+    const auto size = read_length(r);
     if (!size)
         return;
 
-    str.resize(size);
-    r >> gsl::make_span(str);
-
-    if (r.err())
-        str.clear();
+    const auto bytes = r.span(size);
+    if (!r.err())
+        str = {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
 }
 } // namespace kl
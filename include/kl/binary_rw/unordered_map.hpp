@@ -0,0 +1,45 @@
+#pragma once
+
+#include "kl/binary_rw.hpp"
+
+#include <unordered_map>
+#include <utility>
+
+namespace kl {
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Alloc>
+void write_binary(kl::binary_writer& w,
+                  const std::unordered_map<K, V, Hash, KeyEqual, Alloc>& map)
+{
+    write_length(w, map.size());
+
+    for (const auto& kv : map)
+    {
+        w << kv.first;
+        w << kv.second;
+    }
+}
+
+template <typename K, typename V, typename Hash, typename KeyEqual,
+          typename Alloc>
+void read_binary(kl::binary_reader& r,
+                 std::unordered_map<K, V, Hash, KeyEqual, Alloc>& map)
+{
+    const auto size = read_count<std::pair<K, V>>(r);
+    map.clear();
+    // No rehashing while inserting
+    map.reserve(initial_capacity<std::pair<K, V>>(r, size));
+
+    for (std::uint32_t i = 0; i < size; ++i)
+    {
+        auto key = r.read<K>();
+        map.try_emplace(std::move(key), r.read<V>());
+        if (r.err())
+        {
+            map.clear();
+            break;
+        }
+    }
+}
+} // namespace kl
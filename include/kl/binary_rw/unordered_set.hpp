@@ -0,0 +1,38 @@
+#pragma once
+
+#include "kl/binary_rw.hpp"
+
+#include <unordered_set>
+
+namespace kl {
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+void write_binary(kl::binary_writer& w,
+                  const std::unordered_set<T, Hash, KeyEqual, Alloc>& set)
+{
+    write_length(w, set.size());
+
+    for (const auto& key : set)
+        w << key;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+void read_binary(kl::binary_reader& r,
+                 std::unordered_set<T, Hash, KeyEqual, Alloc>& set)
+{
+    const auto size = read_count<T>(r);
+    set.clear();
+    // No rehashing while inserting
+    set.reserve(initial_capacity<T>(r, size));
+
+    for (std::uint32_t i = 0; i < size; ++i)
+    {
+        set.insert(r.read<T>());
+        if (r.err())
+        {
+            set.clear();
+            break;
+        }
+    }
+}
+} // namespace kl
@@ -1,51 +1,120 @@
 #pragma once
 
 #include "kl/binary_rw.hpp"
-#include "kl/meta.hpp"
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
 #include <variant>
 
 namespace kl {
-namespace detail {
+
+// Type of the tag (alternative's index) written before variant's value. It's
+// one byte for up to 256 alternatives and a 16-bit tag is chosen automatically
+// only above that. The tag width is part of the encoding, so specialize this
+// trait to use 16-bit tags up front, i.e. for variants expected to grow past
+// 256 alternatives without changing their format.
+template <typename Variant>
+struct variant_tag
+{
+    using type = std::conditional_t<(std::variant_size_v<Variant> <= 256),
+                                    std::uint8_t, std::uint16_t>;
+};
 
 template <typename Variant>
-void visit_by_index(kl::binary_reader& r, kl::type_pack<>, Variant&,
-                    std::uint8_t)
+using variant_tag_t = typename variant_tag<Variant>::type;
+
+namespace detail {
+
+// Reads into a temporary, `var` is assigned only if the read succeeds
+template <std::size_t I, typename Variant>
+void read_alternative(kl::binary_reader& r, Variant& var)
 {
-    r.notify_error();
+    auto value = r.read<std::variant_alternative_t<I, Variant>>();
+    if (r.err())
+        return;
+    if (auto* current = std::get_if<I>(&var))
+        *current = std::move(value);
+    else
+        var.template emplace<I>(std::move(value));
+}
+
+// Reads in place, reusing the current value if it's the same alternative
+template <std::size_t I, typename Variant>
+void read_alternative_in_place(kl::binary_reader& r, Variant& var)
+{
+    if (auto* value = std::get_if<I>(&var))
+        r >> *value;
+    else
+        r >> var.template emplace<I>();
 }
 
-template <typename Head, typename... Tail, typename Variant>
-void visit_by_index(kl::binary_reader& r, kl::type_pack<Head, Tail...>,
-                    Variant& variant, std::uint8_t index)
+template <typename Variant, bool InPlace, std::size_t... Is>
+constexpr auto make_variant_readers(std::index_sequence<Is...>) noexcept
 {
-    if (index == 0)
+    using reader = void (*)(kl::binary_reader&, Variant&);
+    if constexpr (InPlace)
     {
-        Head value = r.read<Head>();
-        if (!r.err())
-            variant = std::move(value);
+        return std::array<reader, sizeof...(Is)>{
+            &read_alternative_in_place<Is, Variant>...};
     }
     else
     {
-        visit_by_index(r, kl::type_pack<Tail...>{}, variant, index - 1);
+        return std::array<reader, sizeof...(Is)>{
+            &read_alternative<Is, Variant>...};
+    }
+}
+
+template <typename Variant, bool InPlace>
+inline constexpr auto variant_readers = make_variant_readers<Variant, InPlace>(
+    std::make_index_sequence<std::variant_size_v<Variant>>{});
+
+// Dispatches on the tag with one indirect call
+template <bool InPlace, typename Variant>
+void read_variant(kl::binary_reader& r, Variant& var)
+{
+    const auto index = r.read<variant_tag_t<Variant>>();
+    if (r.err())
+        return;
+    if (index >= std::variant_size_v<Variant>)
+    {
+        r.notify_error();
+        return;
     }
+
+    variant_readers<Variant, InPlace>[index](r, var);
 }
 } // namespace detail
 
 template <typename... Args>
 void write_binary(kl::binary_writer& w, const std::variant<Args...>& var)
 {
-    w << static_cast<std::uint8_t>(var.index());
+    using tag_type = variant_tag_t<std::variant<Args...>>;
+    static_assert(sizeof...(Args) - 1 <=
+                      (std::numeric_limits<tag_type>::max)(),
+                  "Too many alternatives for the tag type");
+
+    w << static_cast<tag_type>(var.index());
     std::visit([&w](const auto& value) { w << value; }, var);
 }
 
+// If the read fails, `var` is left unchanged
 template <typename... Args>
 void read_binary(kl::binary_reader& r, std::variant<Args...>& var)
 {
-    const auto index = r.read<std::uint8_t>();
-    if (!r.err())
-    {
-        visit_by_index(r, kl::type_pack<Args...>{}, var, index);
-    }
+    detail::read_variant<false>(r, var);
+}
+
+// Like read_binary() but without a temporary: the alternative selected by the
+// tag is emplace()d and read into, or read over if `var` already holds it
+// (which keeps a string's buffer for example). If the read fails, `var` holds
+// that alternative, possibly partially read.
+template <typename... Args>
+void read_variant_in_place(kl::binary_reader& r, std::variant<Args...>& var)
+{
+    detail::read_variant<true>(r, var);
 }
 } // namespace kl
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "kl/binary_rw.hpp"
+
+#include <type_traits>
+
+namespace kl {
+
+/*
+ * Integer written in LEB128 format: 7 bits per byte, from the least
+ * significant ones. Signed integers are zigzag-encoded first so small negative
+ * values stay short too (0 -> 0, -1 -> 1, 1 -> 2, -2 -> 3, ...).
+
+    struct message
+    {
+        kl::varint<std::uint64_t> id;
+        kl::varint<std::int32_t> delta;
+        std::string text;
+    };
+    KL_REFLECT_STRUCT(message, id, delta, text)
+
+    kl::binary_writer w{buffer};
+    w.set_prefix_format(kl::length_format::varint); // text's length as well
+    w << message{42, -1, "abc"}; // 1 + 1 + 1 + 3 bytes
+ */
+template <typename T>
+class varint
+{
+    static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>,
+                  "T must be an integer type");
+
+public:
+    using value_type = T;
+
+    constexpr varint() noexcept = default;
+    constexpr varint(T value) noexcept : value_{value} {}
+
+    constexpr operator T() const noexcept { return value_; }
+    constexpr T value() const noexcept { return value_; }
+
+private:
+    T value_{};
+};
+
+namespace detail {
+
+template <typename T>
+constexpr std::make_unsigned_t<T> zigzag_encode(T value) noexcept
+{
+    using U = std::make_unsigned_t<T>;
+    if constexpr (std::is_signed_v<T>)
+        return static_cast<U>(static_cast<U>(value) << 1) ^
+               static_cast<U>(value >> (std::numeric_limits<T>::digits));
+    else
+        return value;
+}
+
+template <typename T>
+constexpr T zigzag_decode(std::make_unsigned_t<T> value) noexcept
+{
+    using U = std::make_unsigned_t<T>;
+    if constexpr (std::is_signed_v<T>)
+        return static_cast<T>(static_cast<U>(value >> 1) ^
+                              static_cast<U>(U{0} - (value & 1U)));
+    else
+        return value;
+}
+} // namespace detail
+
+template <typename T>
+void write_binary(kl::binary_writer& w, const varint<T>& value) noexcept
+{
+    detail::write_leb128(w, detail::zigzag_encode(value.value()));
+}
+
+template <typename T>
+void read_binary(kl::binary_reader& r, varint<T>& value) noexcept
+{
+    std::make_unsigned_t<T> encoded{};
+    if (detail::read_leb128(r, encoded))
+        value = detail::zigzag_decode<T>(encoded);
+}
+} // namespace kl
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "kl/binary_rw.hpp"
+#include "kl/binary_rw/reflectable.hpp"
 #include "kl/type_traits.hpp"
 
 #include <vector>
@@ -9,55 +10,84 @@ namespace kl {
 
 namespace detail {
 
-// Specialized operator<< for vector<T> of trivially copyable type T
+// Specialized operator<< for vector<T> of trivially serializable type T
 template <typename T>
 void encode_vector(kl::binary_writer& w, const std::vector<T>& vec,
                    std::true_type /*is_trivially_serializable*/)
 {
-    w << static_cast<std::uint32_t>(vec.size());
+    write_length(w, vec.size());
     w << gsl::span<const T>{vec};
 }
 
+// Reflectables without padding whose fields are reflected in declaration
+// order are written as a whole too, see write_binary for reflectables
+template <typename T>
+constexpr bool may_have_packed_layout() noexcept
+{
+    if constexpr (is_reflectable_v<T>)
+        return is_packed_reflectable_candidate<T>();
+    else
+        return false;
+}
+
+template <typename T>
+bool has_packed_elements() noexcept
+{
+    const reflect_storage<T> storage;
+    return is_packed_reflectable(storage.value);
+}
+
 template <typename T>
 void encode_vector(kl::binary_writer& w, const std::vector<T>& vec,
                    std::false_type /*is_trivially_serializable*/)
 {
-    w << static_cast<std::uint32_t>(vec.size());
+    write_length(w, vec.size());
+
+    if constexpr (may_have_packed_layout<T>())
+    {
+        if (has_packed_elements<T>())
+        {
+            w.write_span(gsl::span<const T>{vec});
+            return;
+        }
+    }
 
     for (const auto& item : vec)
         w << item;
 }
 
-// Specialized operator>> for vector<T> of trivial type T
+// Specialized operator>> for vector<T> of trivially serializable type T
 template <typename T>
 void decode_vector(kl::binary_reader& r, std::vector<T>& vec,
                    std::true_type /*is_trivially_deserializable*/)
 {
-    const auto size = r.read<std::uint32_t>();
+    const auto size = read_count<T>(r);
 
     vec.clear();
 
-    if (size)
-    {
-        vec.resize(size);
-        r >> gsl::span<T>{vec};
-
-        if (r.err())
-        {
-            vec.clear();
-            return;
-        }
-    }
+    if (!detail::read_contiguous<T>(r, vec, size))
+        vec.clear();
 }
 
 template <typename T>
 void decode_vector(kl::binary_reader& r, std::vector<T>& vec,
                    std::false_type /*is_trivially_deserializable*/)
 {
-    const auto size = r.read<std::uint32_t>();
+    const auto size = read_count<T>(r);
 
     vec.clear();
-    vec.reserve(size);
+
+    if constexpr (may_have_packed_layout<T>())
+    {
+        if (has_packed_elements<T>())
+        {
+            if (!detail::read_contiguous<T>(r, vec, size))
+                vec.clear();
+            return;
+        }
+    }
+
+    vec.reserve(initial_capacity<T>(r, size));
 
     for (std::uint32_t i = 0; i < size; ++i)
     {
@@ -69,23 +99,17 @@ void decode_vector(kl::binary_reader& r, std::vector<T>& vec,
         }
     }
 }
-
-template <typename T>
-using is_trivially_serializable = std::bool_constant<is_simple<T>::value>;
-
-template <typename T>
-using is_trivially_deserializable = std::bool_constant<is_simple<T>::value>;
 } // namespace detail
 
 template <typename T>
 void write_binary(kl::binary_writer& w, const std::vector<T>& vec)
 {
-    detail::encode_vector(w, vec, detail::is_trivially_serializable<T>{});
+    detail::encode_vector(w, vec, is_trivially_serializable<T>{});
 }
 
 template <typename T>
 void read_binary(kl::binary_reader& r, std::vector<T>& vec)
 {
-    detail::decode_vector(r, vec, detail::is_trivially_deserializable<T>{});
+    detail::decode_vector(r, vec, is_trivially_serializable<T>{});
 }
 } // namespace kl
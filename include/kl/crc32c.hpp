@@ -0,0 +1,20 @@
+#pragma once
+
+#include <gsl/span>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace kl {
+
+// CRC32C (Castagnoli) of given data. Pass the result back in as `crc` to
+// continue with the next chunk, 0 for the first one. Uses SSE4.2 crc32 and
+// PCLMULQDQ instructions when the CPU has them, slicing-by-8 tables otherwise.
+std::uint32_t crc32c(std::uint32_t crc,
+                     gsl::span<const std::byte> data) noexcept;
+
+inline std::uint32_t crc32c(gsl::span<const std::byte> data) noexcept
+{
+    return crc32c(0, data);
+}
+} // namespace kl
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <exception>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/*
+ * Sample usage:
+
+    std::ifstream in{"config.yaml"};
+    std::ofstream out{"config.json"};
+    kl::transcode::yaml_to_json(in, out);
+
+ * Both directions are driven by parser events (yaml-cpp's EventHandler and
+ * rapidjson's SAX Reader) which are forwarded directly to the other format's
+ * writer (rapidjson::Writer and YAML::Emitter) - no YAML::Node or
+ * rapidjson::Document is built. Memory usage only depends on the nesting depth
+ * (and, for YAML, the size of anchored nodes which are replayed for aliases).
+ *
+ * YAML to JSON:
+ *  - each document of the stream is written as one JSON value on its own line,
+ *  - plain scalars are resolved according to the YAML 1.2 core schema: null,
+ *    true/false, integers (also 0x and 0o prefixed) and floats become their
+ *    JSON counterparts, the number's text is preserved when it's already valid
+ *    JSON. Quoted or tagged scalars as well as .inf and .nan (not representable
+ *    in JSON) become strings,
+ *  - map keys must be scalars, otherwise transcode_error is thrown.
+ *
+ * JSON to YAML:
+ *  - each top-level value of the input (whitespace separated, i.e. JSON Lines)
+ *    becomes a separate document,
+ *  - numbers are written verbatim, strings which would be read back as
+ *    something else (i.e. "true", "12" or "null") are double-quoted.
+ *
+ * Syntax errors are reported with kl::yaml::parse_error and
+ * kl::json::parse_error respectively.
+ */
+
+namespace kl::transcode {
+
+struct transcode_error : std::exception
+{
+    explicit transcode_error(const char* message)
+        : transcode_error{std::string(message)}
+    {
+    }
+
+    explicit transcode_error(std::string message) noexcept
+        : message_{std::move(message)}
+    {
+    }
+
+    virtual ~transcode_error() noexcept;
+
+    const char* what() const noexcept override { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+void yaml_to_json(std::istream& input, std::ostream& sink);
+void yaml_to_json(std::string_view input, std::ostream& sink);
+std::string yaml_to_json(std::string_view input);
+
+void json_to_yaml(std::istream& input, std::ostream& sink);
+void json_to_yaml(std::string_view input, std::ostream& sink);
+std::string json_to_yaml(std::string_view input);
+} // namespace kl::transcode
@@ -9,12 +9,22 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <algorithm>
+#include <array>
 #include <exception>
+#include <fstream>
+#include <functional>
+#include <memory>
 #include <optional>
+#include <ostream>
 #include <string>
 #include <string_view>
 #include <tuple>
 #include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace kl::yaml {
 
@@ -47,12 +57,39 @@ struct optional_traits<std::optional<T>>
     static bool is_null_value(const std::optional<T>& opt) { return !opt; }
 };
 
+template <typename T>
+struct optional_traits<std::shared_ptr<const T>>
+{
+    static bool is_null_value(const std::shared_ptr<const T>& ptr)
+    {
+        return !ptr;
+    }
+};
+
 template <typename T>
 bool is_null_value(const T& t)
 {
     return optional_traits<T>::is_null_value(t);
 }
 
+// Output stream writing to a file through a buffer of given size. Use with
+// dump(obj, sink) to export large documents with bounded memory usage.
+class file_sink : public std::ostream
+{
+public:
+    explicit file_sink(const char* file_path,
+                       std::size_t buffer_size = 64 * 1024);
+    ~file_sink() override;
+
+    // Flushes the buffer and closes the file. Throws std::ios_base::failure
+    // if any of the writes failed.
+    void close();
+
+private:
+    std::vector<char> buffer_;
+    std::filebuf filebuf_;
+};
+
 class dump_context
 {
 public:
@@ -162,8 +199,32 @@ void expect_scalar(const YAML::Node& value);
 void expect_sequence(const YAML::Node& value);
 void expect_map(const YAML::Node& value);
 
+// Converts the YAML scalar to the arithmetic type the same way YAML::Node::as
+// does (hex and octal integers, .inf, .nan, y/yes/true/on, ...) but without a
+// round-trip through std::stringstream. Returns false if the scalar is not a
+// valid representation of given type, leaving `out` unspecified.
+bool parse_scalar(std::string_view str, bool& out) noexcept;
+bool parse_scalar(std::string_view str, signed char& out) noexcept;
+bool parse_scalar(std::string_view str, unsigned char& out) noexcept;
+bool parse_scalar(std::string_view str, short& out) noexcept;
+bool parse_scalar(std::string_view str, unsigned short& out) noexcept;
+bool parse_scalar(std::string_view str, int& out) noexcept;
+bool parse_scalar(std::string_view str, unsigned& out) noexcept;
+bool parse_scalar(std::string_view str, long& out) noexcept;
+bool parse_scalar(std::string_view str, unsigned long& out) noexcept;
+bool parse_scalar(std::string_view str, long long& out) noexcept;
+bool parse_scalar(std::string_view str, unsigned long long& out) noexcept;
+bool parse_scalar(std::string_view str, float& out) noexcept;
+bool parse_scalar(std::string_view str, double& out) noexcept;
+bool parse_scalar(std::string_view str, long double& out) noexcept;
+
 namespace detail {
 
+template <typename T>
+void deserialize_nested(T& out, const YAML::Node& value);
+template <typename T>
+T deserialize_nested(const YAML::Node& value);
+
 template <typename Context>
 class sequence_builder
 {
@@ -235,7 +296,7 @@ public:
     {
         try
         {
-            yaml::deserialize(out, yaml::at(node_, member_name));
+            detail::deserialize_nested(out, yaml::at(node_, member_name));
             return *this;
         }
         catch (deserialize_error& ex)
@@ -271,7 +332,7 @@ public:
     {
         try
         {
-            yaml::deserialize(out, yaml::at(node_, index_));
+            detail::deserialize_nested(out, yaml::at(node_, index_));
             ++index_;
             return *this;
         }
@@ -316,6 +377,54 @@ namespace detail {
 
 std::string type_name(const YAML::Node& value);
 
+// Objects deserialized into shared_ptr<const T> so far, keyed by the node they
+// were deserialized from. All aliases of an anchor refer to the very same node
+// so they can find the object here instead of getting their own deep copy.
+class alias_cache
+{
+public:
+    const std::shared_ptr<const void>* find(const YAML::Node& node,
+                                            const std::type_info& type) const;
+    void insert(const YAML::Node& node, const std::type_info& type,
+                std::shared_ptr<const void> object);
+
+private:
+    struct entry
+    {
+        YAML::Node node;
+        const std::type_info* type;
+        std::shared_ptr<const void> object;
+    };
+
+    // Nodes are bucketed by their position in the source and then compared
+    // for identity
+    std::unordered_multimap<int, entry> entries_;
+};
+
+// The outermost scope on a thread owns the alias cache used by all the nested
+// deserialize calls. The cache is only created once something asks for it.
+class alias_scope
+{
+public:
+    alias_scope() noexcept;
+    ~alias_scope();
+
+    alias_scope(const alias_scope&) = delete;
+    alias_scope& operator=(const alias_scope&) = delete;
+
+    // Returns nullptr if there's no scope on the calling thread
+    static alias_cache* current_cache();
+
+private:
+    bool outermost_;
+    std::optional<alias_cache> cache_;
+};
+
+// `char` is deliberately left out of parse_scalar overloads as yaml-cpp
+// treats it as a single character rather than a number
+KL_VALID_EXPR_HELPER(has_parse_scalar,
+                     yaml::parse_scalar(std::string_view{}, std::declval<T&>()))
+
 using ::kl::detail::has_reserve_v;
 using ::kl::detail::is_growable_range;
 using ::kl::detail::is_map_alike;
@@ -451,6 +560,15 @@ void encode(const std::optional<T>& opt, Context& ctx)
         return yaml::dump(*opt, ctx);
 }
 
+template <typename T, typename Context>
+void encode(const std::shared_ptr<const T>& ptr, Context& ctx)
+{
+    if (!ptr)
+        ctx.emitter() << YAML::Null;
+    else
+        return yaml::dump(*ptr, ctx);
+}
+
 // to_yaml implementation
 
 // For all arithmetic types
@@ -590,6 +708,14 @@ YAML::Node to_yaml(const std::optional<T>& opt, Context& ctx)
     return YAML::Node{};
 }
 
+template <typename T, typename Context>
+YAML::Node to_yaml(const std::shared_ptr<const T>& ptr, Context& ctx)
+{
+    if (ptr)
+        return yaml::serialize(*ptr, ctx);
+    return YAML::Node{};
+}
+
 // from_yaml implementation
 
 template <typename T>
@@ -597,13 +723,23 @@ T from_scalar_yaml(const YAML::Node& value)
 {
     yaml::expect_scalar(value);
 
-    try
+    if constexpr (has_parse_scalar_v<T>)
     {
-        return value.as<T>();
+        T out;
+        if (!yaml::parse_scalar(value.Scalar(), out))
+            throw deserialize_error{YAML::BadConversion{value.Mark()}.what()};
+        return out;
     }
-    catch (const YAML::BadConversion& ex)
+    else
     {
-        throw deserialize_error{ex.what()};
+        try
+        {
+            return value.as<T>();
+        }
+        catch (const YAML::BadConversion& ex)
+        {
+            throw deserialize_error{ex.what()};
+        }
     }
 }
 
@@ -647,9 +783,10 @@ void from_yaml(Map& out, const YAML::Node& value)
         try
         {
             // There's no way to construct K and V directly in the Map
-            out.emplace(
-                yaml::deserialize<typename Map::key_type>(obj.first),
-                yaml::deserialize<typename Map::mapped_type>(obj.second));
+            using K = typename Map::key_type;
+            using V = typename Map::mapped_type;
+            out.emplace(detail::deserialize_nested<K>(obj.first),
+                        detail::deserialize_nested<V>(obj.second));
         }
         catch (deserialize_error& ex)
         {
@@ -677,8 +814,8 @@ void from_yaml(GrowableRange& out, const YAML::Node& value)
         try
         {
             // There's no way to construct T directly in the GrowableRange
-            out.push_back(
-                yaml::deserialize<typename GrowableRange::value_type>(item));
+            using T = typename GrowableRange::value_type;
+            out.push_back(detail::deserialize_nested<T>(item));
         }
         catch (deserialize_error& ex)
         {
@@ -690,15 +827,73 @@ void from_yaml(GrowableRange& out, const YAML::Node& value)
     }
 }
 
+// Returns Reflectable's field names paired with their indices and sorted by
+// the name. Names are only reachable by visiting an instance so the table is
+// built on the first use and shared by all later calls for given type.
+template <typename Reflectable>
+const auto& field_index_table(const Reflectable& refl)
+{
+    using entry = std::pair<std::string, std::size_t>;
+    static const auto table = [&refl] {
+        std::array<entry, ctti::num_fields<Reflectable>()> ret{};
+        ctti::reflect(refl, [&ret, index = std::size_t{}](
+                                auto&, auto name) mutable {
+            ret[index] = entry{std::string(name), index};
+            ++index;
+        });
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    }();
+    return table;
+}
+
+// Walks the map once and assigns each entry to the field of the same name.
+// Fields without a matching entry get a null value, just like yaml::at()
+// would give us. In case of duplicated keys the first one wins.
+template <typename Reflectable>
+auto map_fields(const Reflectable& refl, const YAML::Node& value)
+{
+    constexpr auto num_fields = ctti::num_fields<Reflectable>();
+    const auto& table = field_index_table(refl);
+
+    std::array<YAML::Node, num_fields> fields;
+    std::array<bool, num_fields> assigned{};
+
+    for (const auto& kv : value)
+    {
+        if (!kv.first.IsScalar())
+            continue;
+
+        const std::string_view key = kv.first.Scalar();
+        auto it = std::lower_bound(
+            table.begin(), table.end(), key,
+            [](const auto& e, std::string_view k) { return e.first < k; });
+
+        for (; it != table.end() && it->first == key; ++it)
+        {
+            if (!assigned[it->second])
+            {
+                fields[it->second] = kv.second;
+                assigned[it->second] = true;
+            }
+        }
+    }
+
+    return fields;
+}
+
 template <typename Reflectable>
 void reflectable_from_yaml(Reflectable& out, const YAML::Node& value)
 {
     if (value.IsMap())
     {
-        ctti::reflect(out, [&value](auto& field, auto name) {
+        const auto fields = map_fields(out, value);
+        ctti::reflect(out, [&fields, index = std::size_t{}](
+                               auto& field, auto name) mutable {
             try
             {
-                yaml::deserialize(field, yaml::at(value, name));
+                detail::deserialize_nested(field, fields[index]);
+                ++index;
             }
             catch (deserialize_error& ex)
             {
@@ -720,7 +915,7 @@ void reflectable_from_yaml(Reflectable& out, const YAML::Node& value)
         ctti::reflect(out, [&value, index = 0U](auto& field, auto) mutable {
             try
             {
-                yaml::deserialize(field, yaml::at(value, index));
+                detail::deserialize_nested(field, yaml::at(value, index));
                 ++index;
             }
             catch (deserialize_error& ex)
@@ -785,7 +980,7 @@ void from_yaml(enum_set<Enum>& out, const YAML::Node& value)
 
     for (const auto& v : value)
     {
-        const auto e = yaml::deserialize<Enum>(v);
+        const auto e = detail::deserialize_nested<Enum>(v);
         out |= e;
     }
 }
@@ -794,7 +989,7 @@ template <typename Tuple, std::size_t... Is>
 void tuple_from_yaml(Tuple& out, const YAML::Node& value,
                      std::index_sequence<Is...>)
 {
-    (yaml::deserialize(std::get<Is>(out), yaml::at(value, Is)), ...);
+    (detail::deserialize_nested(std::get<Is>(out), yaml::at(value, Is)), ...);
 }
 
 template <typename... Ts>
@@ -810,7 +1005,32 @@ void from_yaml(std::optional<T>& out, const YAML::Node& value)
     if (!value || value.IsNull())
         return out.reset();
     // There's no way to construct T directly in the optional
-    out = yaml::deserialize<T>(value);
+    out = detail::deserialize_nested<T>(value);
+}
+
+// Within a single top-level deserialize() call, all aliases of an anchor share
+// one object. Memory then scales with the unique content of the document.
+template <typename T>
+void from_yaml(std::shared_ptr<const T>& out, const YAML::Node& value)
+{
+    if (!value || value.IsNull())
+        return out.reset();
+
+    auto* cache = alias_scope::current_cache();
+    if (cache)
+    {
+        if (const auto* object = cache->find(value, typeid(T)))
+        {
+            out = std::static_pointer_cast<const T>(*object);
+            return;
+        }
+    }
+
+    auto object = std::make_shared<T>();
+    detail::deserialize_nested(*object, value);
+    if (cache)
+        cache->insert(value, typeid(T), object);
+    out = std::move(object);
 }
 
 template <typename T, typename Context>
@@ -886,6 +1106,22 @@ auto deserialize(T& out, const YAML::Node& value, priority_tag<2>)
 {
     yaml::serializer<T>::from_yaml(out, value);
 }
+
+// Deserializes a part (field, element) of the value passed to the top-level
+// yaml::deserialize(), using the alias_scope it set up
+template <typename T>
+void deserialize_nested(T& out, const YAML::Node& value)
+{
+    detail::deserialize(out, value, priority_tag<2>{});
+}
+
+template <typename T>
+T deserialize_nested(const YAML::Node& value)
+{
+    T out;
+    detail::deserialize_nested(out, value);
+    return out;
+}
 } // namespace detail
 
 template <typename T>
@@ -898,10 +1134,29 @@ std::string dump(const T& obj)
     return {emitter.c_str()};
 }
 
+// Besides a dump context, `ctx` can also be:
+//  - YAML::Emitter - the object is emitted using it. Allows for reusing the
+//    emitter (and its settings) between calls,
+//  - std::ostream (or anything derived from it, i.e. file_sink) - YAML is
+//    written directly to the stream, without building the whole document in
+//    memory first.
 template <typename T, typename Context>
 void dump(const T& obj, Context& ctx)
 {
-    detail::dump(obj, ctx, priority_tag<3>{});
+    if constexpr (std::is_base_of_v<std::ostream, Context>)
+    {
+        YAML::Emitter emitter{ctx};
+        yaml::dump(obj, emitter);
+    }
+    else if constexpr (std::is_same_v<Context, YAML::Emitter>)
+    {
+        dump_context dump_ctx{ctx};
+        detail::dump(obj, dump_ctx, priority_tag<3>{});
+    }
+    else
+    {
+        detail::dump(obj, ctx, priority_tag<3>{});
+    }
 }
 
 template <typename T>
@@ -920,6 +1175,7 @@ YAML::Node serialize(const T& obj, Context& ctx)
 template <typename T>
 void deserialize(T& out, const YAML::Node& value)
 {
+    detail::alias_scope scope;
     return detail::deserialize(out, value, priority_tag<2>{});
 }
 
@@ -935,6 +1191,57 @@ T deserialize(const YAML::Node& value)
     yaml::deserialize(out, value);
     return out;
 }
+
+namespace detail {
+
+// Splits multi-document YAML stream at document boundaries (`---` and `...`
+// markers at the beginning of a line). Directives and comments preceding a
+// document are kept together with it.
+std::vector<std::string_view> split_documents(std::string_view text);
+
+// Parses single document of a multi-document stream. Parse errors are
+// reported together with the document index.
+YAML::Node load_document(std::string_view document, std::size_t index);
+
+// Calls task(i) for each i in [0, count) using up to num_threads worker
+// threads (0 means as many as there are hardware threads). If any task throws,
+// no new tasks are started and the exception of the one with the lowest index
+// is rethrown once all workers are done.
+void parallel_for(std::size_t count, unsigned num_threads,
+                  const std::function<void(std::size_t)>& task);
+} // namespace detail
+
+// Deserializes each document of multi-document YAML stream to T. Documents
+// are parsed and deserialized concurrently, returned vector keeps their order.
+template <typename T>
+std::vector<T> load_all(std::string_view text, unsigned num_threads = 0)
+{
+    static_assert(std::is_default_constructible_v<T>,
+                  "T must be default constructible");
+    static_assert(!std::is_same_v<T, bool>,
+                  "std::vector<bool> can't be written concurrently");
+
+    const auto documents = detail::split_documents(text);
+    std::vector<T> ret(documents.size());
+
+    detail::parallel_for(
+        documents.size(), num_threads, [&documents, &ret](std::size_t index) {
+            const auto value = detail::load_document(documents[index], index);
+            try
+            {
+                yaml::deserialize(ret[index], value);
+            }
+            catch (deserialize_error& ex)
+            {
+                std::string msg = "error when deserializing document " +
+                                  std::to_string(index);
+                ex.add(msg.c_str());
+                throw;
+            }
+        });
+
+    return ret;
+}
 } // namespace kl::yaml
 
 inline YAML::Node operator""_yaml(const char* s, std::size_t)
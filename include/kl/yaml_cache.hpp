@@ -0,0 +1,185 @@
+#pragma once
+
+#include "kl/binary_rw.hpp"
+#include "kl/binary_rw/growable_writer.hpp"
+#include "kl/binary_rw/map.hpp"
+#include "kl/binary_rw/optional.hpp"
+#include "kl/binary_rw/pair.hpp"
+#include "kl/binary_rw/reflectable.hpp"
+#include "kl/binary_rw/set.hpp"
+#include "kl/binary_rw/string.hpp"
+#include "kl/binary_rw/variant.hpp"
+#include "kl/binary_rw/vector.hpp"
+#include "kl/ctti.hpp"
+#include "kl/detail/concepts.hpp"
+#include "kl/file_view.hpp"
+#include "kl/type_traits.hpp"
+#include "kl/yaml.hpp"
+
+#include <gsl/span>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Sample usage:
+
+    auto config = kl::yaml::cached_load<config_t>("config.yaml", "/var/cache");
+
+ * The first call parses the YAML file and stores the deserialized value in
+ * a compact binary form (using binary_rw) inside the cache directory. Next
+ * calls map the cache file and decode it directly, without touching yaml-cpp,
+ * as long as the YAML file's size, modification time and contents hash as well
+ * as T's schema (see type_schema()) match the ones recorded in the cache. Any
+ * mismatch or corrupted cache file leads to a regular parse and rewrites the
+ * cache.
+ *
+ * T and all of its members must be (de)serializable with both kl::yaml and
+ * kl::binary_rw.
+ */
+
+namespace kl::yaml {
+namespace detail {
+
+struct cache_key
+{
+    std::uint64_t type_hash;
+    std::uint64_t source_size;
+    std::int64_t source_mtime;
+    std::uint64_t source_hash;
+};
+
+cache_key make_cache_key(const std::string& path,
+                         gsl::span<const std::byte> contents,
+                         const std::string& type_schema);
+
+template <typename T>
+void append_type_schema(std::string& out)
+{
+    out += ctti::name<T>();
+    out += '/';
+    out += std::to_string(sizeof(T));
+
+    if constexpr (is_reflectable_v<T>)
+    {
+        out += '{';
+        const T sample{};
+        ctti::reflect(sample, [&](const auto& field, auto name) {
+            out += name;
+            out += ':';
+            append_type_schema<remove_cvref_t<decltype(field)>>(out);
+            out += ';';
+        });
+        out += '}';
+    }
+    else if constexpr (kl::detail::is_map_alike<T>::value)
+    {
+        out += '<';
+        append_type_schema<typename T::key_type>(out);
+        out += ',';
+        append_type_schema<typename T::mapped_type>(out);
+        out += '>';
+    }
+    else if constexpr (kl::detail::has_value_type_v<T>)
+    {
+        if constexpr (!std::is_same_v<typename T::value_type, T>)
+        {
+            out += '<';
+            append_type_schema<typename T::value_type>(out);
+            out += '>';
+        }
+    }
+}
+
+// Describes T for the cache key: its name and size and, recursively, names
+// and types of the reflected fields and element types of the containers.
+// Catches fields being added, removed, renamed or retyped while T's name
+// stays the same.
+template <typename T>
+std::string type_schema()
+{
+    std::string ret;
+    append_type_schema<T>(ret);
+    return ret;
+}
+
+std::string cache_file_path(const std::string& path,
+                            const std::string& cache_dir);
+
+// Returns the serialized value stored in the cache file if the cache's header
+// matches the key and the payload is intact
+std::optional<gsl::span<const std::byte>>
+    cached_payload(gsl::span<const std::byte> cache, const cache_key& key);
+
+// Writes the cache file atomically (through a temporary file). Returns false
+// if the cache could not be written - caching is a best-effort thing.
+bool write_cache_file(const std::string& cache_path, const cache_key& key,
+                      gsl::span<const std::byte> payload);
+
+YAML::Node load_source(gsl::span<const std::byte> contents);
+
+template <typename T>
+std::optional<T> load_cached(const std::string& cache_path,
+                             const cache_key& key)
+{
+    std::optional<kl::file_view> cache;
+    try
+    {
+        cache.emplace(cache_path.c_str());
+    }
+    catch (const std::system_error&)
+    {
+        return std::nullopt;
+    }
+
+    const auto payload = detail::cached_payload(cache->get_bytes(), key);
+    if (!payload)
+        return std::nullopt;
+
+    binary_reader r{*payload};
+    T value{};
+    r >> value;
+    if (r.err() || !r.empty())
+        return std::nullopt;
+    return value;
+}
+
+template <typename T>
+bool store_cached(const std::string& cache_path, const cache_key& key,
+                  const T& value)
+{
+    growable_binary_writer w{(std::max)(
+        std::size_t{256}, static_cast<std::size_t>(key.source_size))};
+    w << value;
+    if (w.err())
+        return false;
+
+    return detail::write_cache_file(cache_path, key, w.finalize());
+}
+} // namespace detail
+
+template <typename T>
+T cached_load(const std::string& path, const std::string& cache_dir)
+{
+    static_assert(std::is_default_constructible_v<T>,
+                  "T must be default constructible");
+
+    const kl::file_view source{path.c_str()};
+    const auto key = detail::make_cache_key(path, source.get_bytes(),
+                                            detail::type_schema<T>());
+    const auto cache_path = detail::cache_file_path(path, cache_dir);
+
+    if (auto cached = detail::load_cached<T>(cache_path, key))
+        return std::move(*cached);
+
+    auto value = yaml::deserialize<T>(detail::load_source(source.get_bytes()));
+    detail::store_cached(cache_path, key, value);
+    return value;
+}
+} // namespace kl::yaml
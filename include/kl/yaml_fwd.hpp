@@ -12,6 +12,7 @@ namespace kl::yaml {
 class view;
 
 class dump_context;
+class file_sink;
 
 template <typename T>
 std::string dump(const T& obj);
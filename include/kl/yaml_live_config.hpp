@@ -0,0 +1,312 @@
+#pragma once
+
+#include "kl/ctti.hpp"
+#include "kl/detail/concepts.hpp"
+#include "kl/file_view.hpp"
+#include "kl/signal.hpp"
+#include "kl/type_traits.hpp"
+#include "kl/yaml.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Sample usage:
+
+    kl::yaml::live_config<config_t> config{"config.yaml"};
+    config.on_change("http").connect([](const config_t& cfg) {
+        http_server.restart(cfg.http);
+    });
+
+    // on SIGHUP (from the thread which owns `config`)
+    config.reload();
+
+    // any thread
+    std::shared_ptr<const config_t> cfg = config.get();
+
+ * reload() re-reads the file and, if its contents changed, deserializes a new
+ * snapshot of T and compares it against the current one, top-level field by
+ * top-level field. Signals connected to a field fire only if that field
+ * compares different. Nested reflectable structs (also inside optionals and
+ * containers) are compared field-wise so they don't need operator==, all the
+ * other types do. shared_ptr<const T> fields are compared by their pointees.
+ *
+ * get() can be called concurrently from any thread, the snapshot it returns
+ * stays valid for as long as the caller holds it. reload() and on_change() are
+ * not thread-safe (neither is kl::signal) and must not be called from within
+ * the connected slots.
+ */
+
+namespace kl::yaml {
+namespace detail {
+
+template <typename T, typename = void>
+struct has_reflected_parts : is_reflectable<T> {};
+
+template <typename T>
+struct has_reflected_parts<std::optional<T>, void> : has_reflected_parts<T> {};
+
+// Pointees are compared, a reload always gives new objects
+template <typename T>
+struct has_reflected_parts<std::shared_ptr<const T>, void> : std::true_type {};
+
+template <typename T, typename U>
+struct has_reflected_parts<std::pair<T, U>, void>
+    : std::disjunction<has_reflected_parts<T>, has_reflected_parts<U>> {};
+
+template <typename Range>
+struct has_reflected_parts<
+    Range, std::enable_if_t<::kl::detail::is_range<Range>::value>>
+    : has_reflected_parts<typename Range::value_type> {};
+
+template <typename T>
+bool values_equal(const T& lhs, const T& rhs);
+
+template <typename T>
+bool values_equal_parts(const std::optional<T>& lhs,
+                        const std::optional<T>& rhs)
+{
+    if (!lhs || !rhs)
+        return !lhs == !rhs;
+    return detail::values_equal(*lhs, *rhs);
+}
+
+template <typename T>
+bool values_equal_parts(const std::shared_ptr<const T>& lhs,
+                        const std::shared_ptr<const T>& rhs)
+{
+    if (!lhs || !rhs)
+        return !lhs == !rhs;
+    return lhs == rhs || detail::values_equal(*lhs, *rhs);
+}
+
+template <typename T, typename U>
+bool values_equal_parts(const std::pair<T, U>& lhs, const std::pair<T, U>& rhs)
+{
+    return detail::values_equal(lhs.first, rhs.first) &&
+           detail::values_equal(lhs.second, rhs.second);
+}
+
+// Calls visitor(lhs_field, rhs_field, index) for each field of two objects of
+// the same reflectable type. Fields of `rhs` are found at the same offsets as
+// the ones of `lhs` so both are visited in a single pass.
+template <typename Reflectable, typename Visitor>
+void reflect_pairwise(const Reflectable& lhs, const Reflectable& rhs,
+                      Visitor&& visitor)
+{
+    const auto* lhs_base = reinterpret_cast<const char*>(&lhs);
+    const auto* rhs_base = reinterpret_cast<const char*>(&rhs);
+
+    std::size_t index = 0;
+    ctti::reflect(lhs, [&](const auto& lhs_field, auto) {
+        using field_type = remove_cvref_t<decltype(lhs_field)>;
+        const auto offset =
+            reinterpret_cast<const char*>(&lhs_field) - lhs_base;
+        const auto& rhs_field =
+            *reinterpret_cast<const field_type*>(rhs_base + offset);
+        visitor(lhs_field, rhs_field, index++);
+    });
+}
+
+KL_HAS_TYPEDEF_HELPER(hasher)
+
+// Unordered containers with a reflectable mapped type, elements are matched
+// by key like operator== does
+template <typename Map>
+bool unordered_maps_equal(const Map& lhs, const Map& rhs)
+{
+    if (lhs.size() != rhs.size())
+        return false;
+
+    for (auto it = lhs.begin(); it != lhs.end();)
+    {
+        const auto lhs_range = lhs.equal_range(it->first);
+        const auto rhs_range = rhs.equal_range(it->first);
+        if (!std::is_permutation(lhs_range.first, lhs_range.second,
+                                 rhs_range.first, rhs_range.second,
+                                 [](const auto& l, const auto& r) {
+                                     return detail::values_equal(l.second,
+                                                                 r.second);
+                                 }))
+        {
+            return false;
+        }
+        it = lhs_range.second;
+    }
+    return true;
+}
+
+template <typename Range>
+bool ranges_equal(const Range& lhs, const Range& rhs)
+{
+    if constexpr (has_hasher_v<Range>)
+    {
+        // Order of the elements is unspecified
+        if constexpr (::kl::detail::has_mapped_type_v<Range>)
+            return detail::unordered_maps_equal(lhs, rhs);
+        else
+            return lhs == rhs;
+    }
+    else
+    {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                          [](const auto& l, const auto& r) {
+                              return detail::values_equal(l, r);
+                          });
+    }
+}
+
+template <typename T>
+bool values_equal(const T& lhs, const T& rhs)
+{
+    if constexpr (!has_reflected_parts<T>::value)
+    {
+        return lhs == rhs;
+    }
+    else if constexpr (is_reflectable_v<T>)
+    {
+        bool equal = true;
+        detail::reflect_pairwise(
+            lhs, rhs, [&equal](const auto& l, const auto& r, std::size_t) {
+                equal = equal && detail::values_equal(l, r);
+            });
+        return equal;
+    }
+    else if constexpr (::kl::detail::is_range<T>::value)
+    {
+        return detail::ranges_equal(lhs, rhs);
+    }
+    else
+    {
+        // std::optional, std::shared_ptr or std::pair
+        return detail::values_equal_parts(lhs, rhs);
+    }
+}
+
+// Returns which top-level fields compare different
+template <typename Reflectable>
+auto changed_fields(const Reflectable& lhs, const Reflectable& rhs)
+{
+    std::array<bool, ctti::num_fields<Reflectable>()> ret{};
+    detail::reflect_pairwise(
+        lhs, rhs, [&ret](const auto& l, const auto& r, std::size_t index) {
+            ret[index] = !detail::values_equal(l, r);
+        });
+    return ret;
+}
+} // namespace detail
+
+template <typename T>
+class live_config
+{
+    static_assert(is_reflectable_v<T>, "T must be a reflectable struct");
+    static_assert(std::is_default_constructible_v<T>,
+                  "T must be default constructible");
+
+public:
+    using snapshot_type = std::shared_ptr<const T>;
+    using signal_type = kl::signal<void(const T&)>;
+
+    // Loads the initial snapshot. Throws just like reload() would.
+    explicit live_config(std::string file_path) : path_{std::move(file_path)}
+    {
+        std::atomic_store(&snapshot_, snapshot_type{load(read_file())});
+    }
+
+    snapshot_type get() const { return std::atomic_load(&snapshot_); }
+
+    // Signal emitted with the new snapshot after a reload that changed given
+    // top-level field. Throws std::invalid_argument for unknown field names.
+    signal_type& on_change(std::string_view field_name)
+    {
+        const auto& table = detail::field_index_table(*get());
+        auto it = std::lower_bound(
+            table.begin(), table.end(), field_name,
+            [](const auto& e, std::string_view k) { return e.first < k; });
+        if (it == table.end() || it->first != field_name)
+        {
+            throw std::invalid_argument{"no field named " +
+                                        std::string{field_name} + " in " +
+                                        ctti::name<T>()};
+        }
+        return field_signals_[it->second];
+    }
+
+    // Signal emitted with the new snapshot after a reload that changed any
+    // field, after all the per-field signals
+    signal_type& on_change() { return changed_; }
+
+    // Returns true if the new snapshot differs from the previous one. If the
+    // file can't be read, parsed or deserialized, an exception is thrown and
+    // the current snapshot is kept.
+    bool reload()
+    {
+        auto text = read_file();
+        // Nothing to do if file didn't change at all
+        if (text == text_)
+            return false;
+
+        snapshot_type next = load(std::move(text));
+        snapshot_type prev = get();
+        const auto changed = detail::changed_fields(*prev, *next);
+        std::atomic_store(&snapshot_, next);
+
+        bool any_changed = false;
+        for (std::size_t i = 0; i < changed.size(); ++i)
+        {
+            if (changed[i])
+            {
+                any_changed = true;
+                field_signals_[i](*next);
+            }
+        }
+        if (any_changed)
+            changed_(*next);
+        return any_changed;
+    }
+
+    const std::string& file_path() const noexcept { return path_; }
+
+private:
+    std::string read_file() const
+    {
+        const kl::file_view file{path_.c_str()};
+        const auto bytes = file.get_bytes();
+        return std::string(reinterpret_cast<const char*>(bytes.data()),
+                           bytes.size());
+    }
+
+    std::shared_ptr<T> load(std::string text)
+    {
+        YAML::Node root;
+        try
+        {
+            root = YAML::Load(text);
+        }
+        catch (const YAML::Exception& ex)
+        {
+            throw parse_error{ex.what()};
+        }
+
+        auto ret = std::make_shared<T>();
+        yaml::deserialize(*ret, root);
+        text_ = std::move(text);
+        return ret;
+    }
+
+private:
+    std::string path_;
+    std::string text_;
+    snapshot_type snapshot_;
+    std::array<signal_type, ctti::num_fields<T>()> field_signals_;
+    signal_type changed_;
+};
+} // namespace kl::yaml
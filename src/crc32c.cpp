@@ -0,0 +1,185 @@
+#include "kl/crc32c.hpp"
+
+#include <array>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define KL_CRC32C_X86 1
+#include <immintrin.h>
+#endif
+
+namespace kl {
+namespace {
+
+// All the functions below work on the raw CRC register, crc32c() inverts it
+// on the way in and out
+
+constexpr std::uint32_t crc32c_polynomial = 0x82f63b78; // reversed
+
+using crc32c_tables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+constexpr crc32c_tables make_crc32c_tables() noexcept
+{
+    crc32c_tables tables{};
+    for (std::uint32_t i = 0; i < 256; ++i)
+    {
+        auto crc = i;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc >> 1) ^ (crc & 1 ? crc32c_polynomial : 0);
+        tables[0][i] = crc;
+    }
+    // tables[k][i] is the CRC of byte i followed by k zero bytes
+    for (std::size_t k = 1; k < tables.size(); ++k)
+    {
+        for (std::size_t i = 0; i < 256; ++i)
+        {
+            const auto prev = tables[k - 1][i];
+            tables[k][i] = (prev >> 8) ^ tables[0][prev & 0xff];
+        }
+    }
+    return tables;
+}
+
+constexpr crc32c_tables tables = make_crc32c_tables();
+
+std::uint32_t crc32c_slicing8(std::uint32_t crc, const std::uint8_t* data,
+                              std::size_t size) noexcept
+{
+    for (; size >= 8; data += 8, size -= 8)
+    {
+        crc ^= std::uint32_t{data[0]} | std::uint32_t{data[1]} << 8 |
+               std::uint32_t{data[2]} << 16 | std::uint32_t{data[3]} << 24;
+        crc = tables[7][crc & 0xff] ^ tables[6][(crc >> 8) & 0xff] ^
+              tables[5][(crc >> 16) & 0xff] ^ tables[4][crc >> 24] ^
+              tables[3][data[4]] ^ tables[2][data[5]] ^ tables[1][data[6]] ^
+              tables[0][data[7]];
+    }
+    for (; size > 0; ++data, --size)
+        crc = tables[0][(crc ^ *data) & 0xff] ^ (crc >> 8);
+    return crc;
+}
+
+#if defined(KL_CRC32C_X86)
+
+std::uint64_t load64(const std::uint8_t* data) noexcept
+{
+    std::uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    return word;
+}
+
+__attribute__((target("sse4.2"))) std::uint32_t
+crc32c_sse42(std::uint32_t crc, const std::uint8_t* data,
+             std::size_t size) noexcept
+{
+    std::uint64_t crc64 = crc;
+    for (; size >= 8; data += 8, size -= 8)
+        crc64 = _mm_crc32_u64(crc64, load64(data));
+
+    crc = static_cast<std::uint32_t>(crc64);
+    for (; size > 0; ++data, --size)
+        crc = _mm_crc32_u8(crc, *data);
+    return crc;
+}
+
+// x^n mod P, bit-reflected like the CRC register
+constexpr std::uint32_t x_pow_mod(std::size_t n) noexcept
+{
+    std::uint32_t ret = 0x80000000; // x^0
+    for (; n > 0; --n)
+        ret = (ret >> 1) ^ (ret & 1 ? crc32c_polynomial : 0);
+    return ret;
+}
+
+// Multiplying the register by x^(8 * Length - 33) and feeding the 64-bit
+// product through crc32 (which multiplies by another x^32 and reduces, the
+// remaining x comes from clmul of reflected operands) gives the register
+// followed by Length zero bytes
+template <std::size_t Length>
+inline constexpr std::uint32_t shift_constant = x_pow_mod(8 * Length - 33);
+
+template <std::size_t Length>
+__attribute__((target("sse4.2,pclmul"))) std::uint32_t
+shift_crc(std::uint32_t crc) noexcept
+{
+    const auto product = _mm_clmulepi64_si128(
+        _mm_cvtsi32_si128(static_cast<int>(crc)),
+        _mm_cvtsi32_si128(static_cast<int>(shift_constant<Length>)), 0);
+    return static_cast<std::uint32_t>(_mm_crc32_u64(
+        0, static_cast<std::uint64_t>(_mm_cvtsi128_si64(product))));
+}
+
+// crc32 has 3-cycle latency but 1-cycle throughput: run three independent
+// streams over consecutive lanes and combine them with clmul afterwards
+template <std::size_t Lane>
+__attribute__((target("sse4.2,pclmul"))) std::uint32_t
+crc32c_3way(std::uint32_t crc, const std::uint8_t*& data,
+            std::size_t& size) noexcept
+{
+    static_assert(Lane % 8 == 0);
+
+    for (; size >= 3 * Lane; data += 3 * Lane, size -= 3 * Lane)
+    {
+        std::uint64_t crc0 = crc, crc1 = 0, crc2 = 0;
+        for (std::size_t i = 0; i < Lane; i += 8)
+        {
+            crc0 = _mm_crc32_u64(crc0, load64(data + i));
+            crc1 = _mm_crc32_u64(crc1, load64(data + Lane + i));
+            crc2 = _mm_crc32_u64(crc2, load64(data + 2 * Lane + i));
+        }
+
+        crc = shift_crc<Lane>(static_cast<std::uint32_t>(crc0)) ^
+              static_cast<std::uint32_t>(crc1);
+        crc = shift_crc<Lane>(crc) ^ static_cast<std::uint32_t>(crc2);
+    }
+    return crc;
+}
+
+__attribute__((target("sse4.2,pclmul"))) std::uint32_t
+crc32c_sse42_clmul(std::uint32_t crc, const std::uint8_t* data,
+                   std::size_t size) noexcept
+{
+    crc = crc32c_3way<8192>(crc, data, size);
+    crc = crc32c_3way<256>(crc, data, size);
+    return crc32c_sse42(crc, data, size);
+}
+
+using crc32c_fn = std::uint32_t (*)(std::uint32_t, const std::uint8_t*,
+                                    std::size_t) noexcept;
+
+crc32c_fn select_crc32c() noexcept
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2"))
+    {
+        return __builtin_cpu_supports("pclmul") ? &crc32c_sse42_clmul
+                                                : &crc32c_sse42;
+    }
+    return &crc32c_slicing8;
+}
+
+std::uint32_t crc32c_dispatch(std::uint32_t crc, const std::uint8_t* data,
+                              std::size_t size) noexcept
+{
+    static const auto impl = select_crc32c();
+    return impl(crc, data, size);
+}
+
+#else
+
+std::uint32_t crc32c_dispatch(std::uint32_t crc, const std::uint8_t* data,
+                              std::size_t size) noexcept
+{
+    return crc32c_slicing8(crc, data, size);
+}
+
+#endif
+} // namespace
+
+std::uint32_t crc32c(std::uint32_t crc,
+                     gsl::span<const std::byte> data) noexcept
+{
+    return ~crc32c_dispatch(
+        ~crc, reinterpret_cast<const std::uint8_t*>(data.data()), data.size());
+}
+} // namespace kl
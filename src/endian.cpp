@@ -0,0 +1,126 @@
+#include "kl/binary_rw/endian.hpp"
+
+#include <boost/endian/conversion.hpp>
+
+#if (defined(__GNUC__) || defined(__clang__)) &&                               \
+    (defined(__x86_64__) || defined(__i386__))
+#define KL_BYTE_SWAP_X86 1
+#include <immintrin.h>
+#endif
+
+namespace kl::detail {
+namespace {
+
+template <typename T>
+void byte_swap_scalar(T* data, std::size_t count) noexcept
+{
+    for (std::size_t i = 0; i < count; ++i)
+        boost::endian::endian_reverse_inplace(data[i]);
+}
+
+#if defined(KL_BYTE_SWAP_X86)
+
+// pshufb mask reversing bytes of each T-sized element within 16 bytes
+template <typename T>
+struct reverse_mask
+{
+    alignas(16) std::int8_t bytes[16];
+
+    constexpr reverse_mask() noexcept : bytes{}
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            const int size = sizeof(T);
+            bytes[i] = static_cast<std::int8_t>(i / size * size +
+                                                (size - 1 - i % size));
+        }
+    }
+};
+
+template <typename T>
+inline constexpr reverse_mask<T> reverse_mask_v{};
+
+template <typename T>
+__attribute__((target("ssse3"))) void
+byte_swap_ssse3(T* data, std::size_t count) noexcept
+{
+    const auto mask = _mm_load_si128(
+        reinterpret_cast<const __m128i*>(reverse_mask_v<T>.bytes));
+    constexpr std::size_t per_vector = 16 / sizeof(T);
+
+    std::size_t i = 0;
+    for (; i + per_vector <= count; i += per_vector)
+    {
+        auto* p = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), mask));
+    }
+    byte_swap_scalar(data + i, count - i);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) void
+byte_swap_avx2(T* data, std::size_t count) noexcept
+{
+    // vpshufb shuffles within 128-bit lanes so the same mask goes to both
+    const auto mask = _mm256_broadcastsi128_si256(_mm_load_si128(
+        reinterpret_cast<const __m128i*>(reverse_mask_v<T>.bytes)));
+    constexpr std::size_t per_vector = 32 / sizeof(T);
+
+    std::size_t i = 0;
+    for (; i + per_vector <= count; i += per_vector)
+    {
+        auto* p = reinterpret_cast<__m256i*>(data + i);
+        _mm256_storeu_si256(p,
+                            _mm256_shuffle_epi8(_mm256_loadu_si256(p), mask));
+    }
+    byte_swap_ssse3(data + i, count - i);
+}
+
+template <typename T>
+using byte_swap_fn = void (*)(T*, std::size_t) noexcept;
+
+template <typename T>
+byte_swap_fn<T> select_byte_swap() noexcept
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return &byte_swap_avx2<T>;
+    if (__builtin_cpu_supports("ssse3"))
+        return &byte_swap_ssse3<T>;
+    return &byte_swap_scalar<T>;
+}
+
+template <typename T>
+void byte_swap_dispatch(T* data, std::size_t count) noexcept
+{
+    static const auto impl = select_byte_swap<T>();
+    impl(data, count);
+}
+
+#else
+
+template <typename T>
+void byte_swap_dispatch(T* data, std::size_t count) noexcept
+{
+    // Simple enough for the compiler to vectorize
+    byte_swap_scalar(data, count);
+}
+
+#endif
+} // namespace
+
+void byte_swap(std::uint16_t* data, std::size_t count) noexcept
+{
+    byte_swap_dispatch(data, count);
+}
+
+void byte_swap(std::uint32_t* data, std::size_t count) noexcept
+{
+    byte_swap_dispatch(data, count);
+}
+
+void byte_swap(std::uint64_t* data, std::size_t count) noexcept
+{
+    byte_swap_dispatch(data, count);
+}
+} // namespace kl::detail
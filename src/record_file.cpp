@@ -0,0 +1,185 @@
+#include "kl/binary_rw/record_file.hpp"
+#include "kl/crc32c.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <system_error>
+
+namespace kl {
+namespace {
+
+[[noreturn]] void throw_system_error()
+{
+    throw std::system_error{static_cast<int>(errno), std::generic_category()};
+}
+
+template <typename T>
+T load(const std::byte* data) noexcept
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+} // namespace
+
+record_file_writer::record_file_writer(const char* file_path,
+                                       length_format format)
+    : file_{std::fopen(file_path, "wb")}, format_{format}
+{
+    if (!file_)
+        throw_system_error();
+
+    const detail::record_file_header header{
+        detail::record_file_magic, detail::record_file_version,
+        static_cast<std::uint8_t>(format), 0};
+    write(file_.get(), &header, sizeof(header));
+}
+
+record_file_writer::~record_file_writer()
+{
+    try
+    {
+        if (file_)
+            close();
+    }
+    catch (...)
+    {
+    }
+}
+
+void record_file_writer::append_segments(
+    const std::vector<gsl::span<const std::byte>>& data)
+{
+    detail::record_header header{0, 0};
+    std::size_t size = 0;
+    for (const auto& segment : data)
+    {
+        size += segment.size();
+        header.checksum = crc32c(header.checksum, segment);
+    }
+    if (size > (std::numeric_limits<std::uint32_t>::max)())
+        throw record_file_error{"record too big"};
+    if (!file_)
+        throw record_file_error{"record file is closed"};
+    header.size = static_cast<std::uint32_t>(size);
+
+    offsets_.reserve(offsets_.size() + 1);
+    const auto offset = offset_;
+    write(file_.get(), &header, sizeof(header));
+    for (const auto& segment : data)
+        write(file_.get(), segment.data(), segment.size());
+    offsets_.push_back(offset);
+}
+
+void record_file_writer::close()
+{
+    if (!file_)
+        return;
+
+    // Taken over first so that if writing the index fails the destructor
+    // doesn't append another one
+    auto file = std::move(file_);
+
+    const auto* index = reinterpret_cast<const std::byte*>(offsets_.data());
+    const auto index_size = offsets_.size() * sizeof(std::uint64_t);
+
+    const detail::record_file_footer footer{
+        offset_, offsets_.size(), crc32c(0, {index, index_size}),
+        detail::record_index_magic};
+    write(file.get(), index, index_size);
+    write(file.get(), &footer, sizeof(footer));
+
+    if (std::fclose(file.release()) != 0)
+        throw_system_error();
+}
+
+void record_file_writer::write(std::FILE* file, const void* data,
+                               std::size_t size)
+{
+    if (size > 0 && std::fwrite(data, 1, size, file) != size)
+        throw_system_error();
+    offset_ += size;
+}
+
+record_file::record_file(const char* file_path)
+    : view_{std::in_place, file_path}, bytes_{view_->get_bytes()}
+{
+    open();
+}
+
+record_file::record_file(gsl::span<const std::byte> bytes) : bytes_{bytes}
+{
+    open();
+}
+
+void record_file::open()
+{
+    using detail::record_file_footer;
+    using detail::record_file_header;
+
+    if (bytes_.size() < sizeof(record_file_header) + sizeof(record_file_footer))
+        throw record_file_error{"not a record file"};
+
+    const auto header = load<record_file_header>(bytes_.data());
+    if (header.magic != detail::record_file_magic)
+        throw record_file_error{"not a record file"};
+    if (header.version != detail::record_file_version)
+        throw record_file_error{"unsupported record file version"};
+    if (header.format > static_cast<std::uint8_t>(length_format::varint))
+        throw record_file_error{"unknown length format"};
+    format_ = static_cast<length_format>(header.format);
+
+    const auto footer_offset = bytes_.size() - sizeof(record_file_footer);
+    const auto footer = load<record_file_footer>(bytes_.data() + footer_offset);
+    if (footer.magic != detail::record_index_magic)
+        throw record_file_error{"record file is incomplete"};
+
+    // Index must fit exactly between the records and the footer
+    if (footer.index_offset < sizeof(record_file_header) ||
+        footer.index_offset > footer_offset ||
+        (footer_offset - footer.index_offset) / sizeof(std::uint64_t) !=
+            footer.count ||
+        (footer_offset - footer.index_offset) % sizeof(std::uint64_t) != 0)
+    {
+        throw record_file_error{"corrupted record index"};
+    }
+
+    index_ = bytes_.data() + footer.index_offset;
+    index_offset_ = footer.index_offset;
+    count_ = static_cast<std::size_t>(footer.count);
+
+    const auto index_size = count_ * sizeof(std::uint64_t);
+    if (crc32c(0, {index_, index_size}) != footer.index_checksum)
+        throw record_file_error{"corrupted record index"};
+}
+
+gsl::span<const std::byte> record_file::record(std::size_t n) const
+{
+    if (n >= count_)
+        throw std::out_of_range{"record number out of range"};
+
+    const auto offset =
+        load<std::uint64_t>(index_ + n * sizeof(std::uint64_t));
+    if (offset < sizeof(detail::record_file_header) ||
+        offset > index_offset_ ||
+        index_offset_ - offset < sizeof(detail::record_header))
+    {
+        throw record_file_error{"corrupted record index"};
+    }
+
+    const auto* data = bytes_.data() + offset;
+    const auto header = load<detail::record_header>(data);
+    data += sizeof(header);
+    if (header.size >
+        index_offset_ - offset - sizeof(detail::record_header))
+    {
+        throw record_file_error{"corrupted record " + std::to_string(n)};
+    }
+
+    const gsl::span<const std::byte> payload{data, header.size};
+    if (crc32c(0, payload) != header.checksum)
+        throw record_file_error{"corrupted record " + std::to_string(n)};
+    return payload;
+}
+} // namespace kl
@@ -0,0 +1,67 @@
+#include "kl/binary_rw/stream_reader.hpp"
+
+#include <istream>
+#include <limits>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include <errno.h>
+
+namespace kl {
+
+binary_source fd_source(int fd)
+{
+    return [fd](gsl::span<std::byte> buffer) -> std::size_t {
+#if defined(_WIN32)
+        const auto size = static_cast<unsigned int>((std::min)(
+            buffer.size(),
+            std::size_t{(std::numeric_limits<int>::max)()}));
+        const auto ret = ::_read(fd, buffer.data(), size);
+        return ret > 0 ? static_cast<std::size_t>(ret) : 0;
+#else
+        for (;;)
+        {
+            const auto ret = ::read(fd, buffer.data(), buffer.size());
+            if (ret >= 0)
+                return static_cast<std::size_t>(ret);
+            if (errno != EINTR)
+                return 0;
+        }
+#endif
+    };
+}
+
+binary_source istream_source(std::istream& is)
+{
+    return [&is](gsl::span<std::byte> buffer) -> std::size_t {
+        const auto size = static_cast<std::streamsize>((std::min)(
+            buffer.size(),
+            static_cast<std::size_t>(
+                (std::numeric_limits<std::streamsize>::max)())));
+        // Take what's already available first so we don't block needlessly
+        auto count = is.readsome(reinterpret_cast<char*>(buffer.data()), size);
+        if (count > 0)
+            return static_cast<std::size_t>(count);
+        if (size == 0)
+            return 0;
+
+        // Nothing buffered: block for one byte only, reading the full size
+        // would wait for the whole buffer to fill up
+        const auto c = is.get();
+        if (c == std::istream::traits_type::eof())
+        {
+            is.clear(is.rdstate() & ~std::ios_base::failbit);
+            return 0;
+        }
+        buffer[0] = static_cast<std::byte>(c);
+
+        // Then take whatever came with it
+        count = is.readsome(reinterpret_cast<char*>(buffer.data()) + 1,
+                            size - 1);
+        return count > 0 ? static_cast<std::size_t>(count) + 1 : 1;
+    };
+}
+} // namespace kl
@@ -0,0 +1,576 @@
+#include "kl/transcode.hpp"
+#include "kl/json.hpp"
+#include "kl/yaml.hpp"
+
+#include <rapidjson/error/en.h>
+#include <rapidjson/istreamwrapper.h>
+#include <rapidjson/memorystream.h>
+#include <rapidjson/reader.h>
+#include <rapidjson/writer.h>
+
+#include <yaml-cpp/emitter.h>
+#include <yaml-cpp/eventhandler.h>
+#include <yaml-cpp/mark.h>
+#include <yaml-cpp/parser.h>
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace kl::transcode {
+
+transcode_error::~transcode_error() noexcept = default;
+
+namespace {
+
+bool is_digit(char ch) noexcept { return '0' <= ch && ch <= '9'; }
+
+bool is_core_null(std::string_view str) noexcept
+{
+    return str.empty() || str == "~" || str == "null" || str == "Null" ||
+           str == "NULL";
+}
+
+bool parse_core_bool(std::string_view str, bool& out) noexcept
+{
+    if (str == "true" || str == "True" || str == "TRUE")
+        out = true;
+    else if (str == "false" || str == "False" || str == "FALSE")
+        out = false;
+    else
+        return false;
+    return true;
+}
+
+// Rewrites YAML 1.2 core schema decimal number
+// `[-+]?(\.[0-9]+|[0-9]+(\.[0-9]*)?)([eE][-+]?[0-9]+)?` in JSON number syntax,
+// i.e. `+.5` becomes `0.5` and `007` becomes `7`. Returns false if `str`
+// isn't one.
+bool to_json_number(std::string_view str, std::string& out)
+{
+    std::size_t pos = 0;
+    const auto take_digits = [&] {
+        const auto first = pos;
+        while (pos < str.size() && is_digit(str[pos]))
+            ++pos;
+        return str.substr(first, pos - first);
+    };
+
+    out.clear();
+    if (pos < str.size() && (str[pos] == '-' || str[pos] == '+'))
+    {
+        if (str[pos] == '-')
+            out += '-';
+        ++pos;
+    }
+
+    const auto integer = take_digits();
+    std::string_view fraction;
+    if (pos < str.size() && str[pos] == '.')
+    {
+        ++pos;
+        fraction = take_digits();
+    }
+    if (integer.empty() && fraction.empty())
+        return false;
+
+    std::string_view exponent_sign, exponent;
+    if (pos < str.size() && (str[pos] == 'e' || str[pos] == 'E'))
+    {
+        ++pos;
+        if (pos < str.size() && (str[pos] == '-' || str[pos] == '+'))
+            exponent_sign = str.substr(pos++, 1);
+        exponent = take_digits();
+        if (exponent.empty())
+            return false;
+    }
+    if (pos != str.size())
+        return false;
+
+    const auto first_non_zero = integer.find_first_not_of('0');
+    if (first_non_zero == std::string_view::npos)
+        out += '0';
+    else
+        out += integer.substr(first_non_zero);
+    if (!fraction.empty())
+        out.append(".").append(fraction);
+    if (!exponent.empty())
+        out.append("e").append(exponent_sign).append(exponent);
+    return true;
+}
+
+// YAML 1.2 core schema `0x[0-9a-fA-F]+` and `0o[0-7]+`
+bool parse_core_prefixed_int(std::string_view str, std::uint64_t& out) noexcept
+{
+    if (str.size() < 3 || str[0] != '0')
+        return false;
+
+    int base;
+    if (str[1] == 'x')
+        base = 16;
+    else if (str[1] == 'o')
+        base = 8;
+    else
+        return false;
+
+    const auto* last = str.data() + str.size();
+    const auto res = std::from_chars(str.data() + 2, last, out, base);
+    return res.ec == std::errc{} && res.ptr == last;
+}
+
+// Whether plain scalar would be read as something else than a string, either
+// by yaml-cpp (which is more liberal, i.e. `yes` is a boolean too) or by
+// yaml_to_json()
+bool needs_quotes(std::string_view str) noexcept
+{
+    bool b;
+    double d;
+    long long ll;
+    unsigned long long ull;
+    std::uint64_t u64;
+    return is_core_null(str) || yaml::parse_scalar(str, b) ||
+           yaml::parse_scalar(str, d) || yaml::parse_scalar(str, ll) ||
+           yaml::parse_scalar(str, ull) || parse_core_prefixed_int(str, u64);
+}
+
+std::string error_at(const YAML::Mark& mark, const char* message)
+{
+    return "error at line " + std::to_string(mark.line + 1) + ", column " +
+           std::to_string(mark.column + 1) + ": " + message;
+}
+
+class view_streambuf : public std::streambuf
+{
+public:
+    explicit view_streambuf(std::string_view text)
+    {
+        auto* data = const_cast<char*>(text.data());
+        setg(data, data, data + text.size());
+    }
+};
+
+// rapidjson output stream writing to std::ostream in chunks
+class ostream_adapter
+{
+public:
+    using Ch = char;
+
+    explicit ostream_adapter(std::ostream& sink) : sink_{sink} {}
+
+    void Put(char ch)
+    {
+        buffer_[size_++] = ch;
+        if (size_ == buffer_.size())
+            Flush();
+    }
+
+    void Flush()
+    {
+        sink_.write(buffer_.data(), static_cast<std::streamsize>(size_));
+        size_ = 0;
+    }
+
+private:
+    std::ostream& sink_;
+    std::array<char, 4096> buffer_;
+    std::size_t size_ = 0;
+};
+
+enum class event_type
+{
+    null,
+    plain_scalar,
+    scalar, // quoted or tagged
+    sequence_start,
+    sequence_end,
+    map_start,
+    map_end
+};
+
+struct event
+{
+    event_type type;
+    std::string_view value;
+};
+
+struct stored_event
+{
+    event_type type;
+    std::string value;
+};
+
+class json_writing_handler final : public YAML::EventHandler
+{
+public:
+    explicit json_writing_handler(std::ostream& sink)
+        : sink_{sink}, writer_{sink_}
+    {
+    }
+
+    void OnDocumentStart(const YAML::Mark&) override
+    {
+        writer_.Reset(sink_);
+        anchors_.clear();
+    }
+
+    void OnDocumentEnd() override
+    {
+        sink_.Put('\n');
+        sink_.Flush();
+    }
+
+    void OnNull(const YAML::Mark& mark, YAML::anchor_t anchor) override
+    {
+        handle({event_type::null, {}}, anchor, mark);
+    }
+
+    void OnAlias(const YAML::Mark& mark, YAML::anchor_t anchor) override
+    {
+        const auto it = anchors_.find(anchor);
+        if (it == anchors_.end())
+        {
+            throw transcode_error{
+                error_at(mark, "recursive aliases can't be expressed in JSON")};
+        }
+        // Events are replayed as if the node was written again
+        for (const auto& ev : it->second)
+            handle({ev.type, ev.value}, YAML::NullAnchor, mark);
+    }
+
+    void OnScalar(const YAML::Mark& mark, const std::string& tag,
+                  YAML::anchor_t anchor, const std::string& value) override
+    {
+        // Plain scalars are tagged with "?", quoted ones with "!"
+        const auto type =
+            tag == "?" ? event_type::plain_scalar : event_type::scalar;
+        handle({type, value}, anchor, mark);
+    }
+
+    void OnSequenceStart(const YAML::Mark& mark, const std::string&,
+                         YAML::anchor_t anchor,
+                         YAML::EmitterStyle::value) override
+    {
+        handle({event_type::sequence_start, {}}, anchor, mark);
+    }
+
+    void OnSequenceEnd() override
+    {
+        handle({event_type::sequence_end, {}}, YAML::NullAnchor,
+               YAML::Mark::null_mark());
+    }
+
+    void OnMapStart(const YAML::Mark& mark, const std::string&,
+                    YAML::anchor_t anchor, YAML::EmitterStyle::value) override
+    {
+        handle({event_type::map_start, {}}, anchor, mark);
+    }
+
+    void OnMapEnd() override
+    {
+        handle({event_type::map_end, {}}, YAML::NullAnchor,
+               YAML::Mark::null_mark());
+    }
+
+private:
+    struct level
+    {
+        bool is_map;
+        bool expects_key;
+    };
+
+    struct recording
+    {
+        YAML::anchor_t anchor;
+        int depth;
+        std::vector<stored_event> events;
+    };
+
+    void handle(const event& ev, YAML::anchor_t anchor, const YAML::Mark& mark)
+    {
+        if (anchor != YAML::NullAnchor)
+            recordings_.push_back(recording{anchor, 0, {}});
+
+        write(ev, mark);
+
+        if (recordings_.empty())
+            return;
+
+        const int depth_change = ev.type == event_type::sequence_start ||
+                                         ev.type == event_type::map_start
+                                     ? 1
+                                 : ev.type == event_type::sequence_end ||
+                                         ev.type == event_type::map_end
+                                     ? -1
+                                     : 0;
+        for (auto& rec : recordings_)
+        {
+            rec.events.push_back(stored_event{ev.type, std::string{ev.value}});
+            rec.depth += depth_change;
+        }
+
+        // Anchored nodes are nested so the innermost one completes first
+        while (!recordings_.empty() && recordings_.back().depth == 0)
+        {
+            auto& rec = recordings_.back();
+            anchors_[rec.anchor] = std::move(rec.events);
+            recordings_.pop_back();
+        }
+    }
+
+    bool expects_key() const noexcept
+    {
+        return !levels_.empty() && levels_.back().expects_key;
+    }
+
+    void value_written() noexcept
+    {
+        if (!levels_.empty() && levels_.back().is_map)
+            levels_.back().expects_key = true;
+    }
+
+    void write(const event& ev, const YAML::Mark& mark)
+    {
+        switch (ev.type)
+        {
+        case event_type::null:
+            if (expects_key())
+                return write_key("null");
+            writer_.Null();
+            return value_written();
+
+        case event_type::plain_scalar:
+        case event_type::scalar:
+            if (expects_key())
+                return write_key(ev.value);
+            if (ev.type == event_type::plain_scalar)
+                write_plain_scalar(ev.value);
+            else
+                write_string(ev.value);
+            return value_written();
+
+        case event_type::sequence_start:
+        case event_type::map_start:
+            if (expects_key())
+            {
+                throw transcode_error{error_at(
+                    mark, "only scalar map keys can be expressed in JSON")};
+            }
+            if (ev.type == event_type::map_start)
+            {
+                writer_.StartObject();
+                levels_.push_back(level{true, true});
+            }
+            else
+            {
+                writer_.StartArray();
+                levels_.push_back(level{false, false});
+            }
+            return;
+
+        case event_type::sequence_end:
+        case event_type::map_end:
+            levels_.pop_back();
+            if (ev.type == event_type::map_end)
+                writer_.EndObject();
+            else
+                writer_.EndArray();
+            return value_written();
+        }
+    }
+
+    void write_key(std::string_view key)
+    {
+        writer_.Key(key.data(), static_cast<rapidjson::SizeType>(key.size()),
+                    true);
+        levels_.back().expects_key = false;
+    }
+
+    void write_string(std::string_view value)
+    {
+        writer_.String(value.data(),
+                       static_cast<rapidjson::SizeType>(value.size()), true);
+    }
+
+    void write_plain_scalar(std::string_view value)
+    {
+        bool b;
+        std::uint64_t u64;
+        if (parse_core_bool(value, b))
+            writer_.Bool(b);
+        else if (to_json_number(value, number_))
+            writer_.RawValue(number_.data(), number_.size(),
+                             rapidjson::kNumberType);
+        else if (parse_core_prefixed_int(value, u64))
+            writer_.Uint64(u64);
+        else
+            write_string(value);
+    }
+
+private:
+    ostream_adapter sink_;
+    rapidjson::Writer<ostream_adapter> writer_;
+    std::vector<level> levels_;
+    std::vector<recording> recordings_;
+    std::unordered_map<YAML::anchor_t, std::vector<stored_event>> anchors_;
+    std::string number_;
+};
+
+class yaml_emitting_handler
+{
+public:
+    explicit yaml_emitting_handler(std::ostream& sink) : emitter_{sink} {}
+
+    void begin_document(std::size_t index)
+    {
+        if (index > 0)
+            emitter_ << YAML::BeginDoc;
+    }
+
+    bool Null() { return scalar(YAML::Null); }
+    bool Bool(bool b) { return scalar(b); }
+    bool Int(int i) { return scalar(i); }
+    bool Uint(unsigned u) { return scalar(u); }
+    bool Int64(std::int64_t i) { return scalar(i); }
+    bool Uint64(std::uint64_t u) { return scalar(u); }
+    bool Double(double d) { return scalar(d); }
+
+    bool RawNumber(const char* str, rapidjson::SizeType length, bool)
+    {
+        // Valid JSON number is always a valid plain scalar
+        return scalar(std::string(str, length));
+    }
+
+    bool String(const char* str, rapidjson::SizeType length, bool)
+    {
+        return write_string({str, length});
+    }
+
+    bool StartObject() { return scalar(YAML::BeginMap); }
+
+    bool Key(const char* str, rapidjson::SizeType length, bool)
+    {
+        emitter_ << YAML::Key;
+        write_string({str, length});
+        return scalar(YAML::Value);
+    }
+
+    bool EndObject(rapidjson::SizeType) { return scalar(YAML::EndMap); }
+    bool StartArray() { return scalar(YAML::BeginSeq); }
+    bool EndArray(rapidjson::SizeType) { return scalar(YAML::EndSeq); }
+
+    // YAML::Emitter::GetLastError() returns by value
+    std::string error() const { return emitter_.GetLastError(); }
+
+private:
+    template <typename T>
+    bool scalar(const T& value)
+    {
+        emitter_ << value;
+        return emitter_.good();
+    }
+
+    bool write_string(std::string_view str)
+    {
+        if (needs_quotes(str))
+            emitter_ << YAML::DoubleQuoted;
+        return scalar(std::string{str});
+    }
+
+private:
+    YAML::Emitter emitter_;
+};
+
+template <typename InputStream>
+void skip_whitespace(InputStream& is)
+{
+    for (;;)
+    {
+        const auto ch = is.Peek();
+        if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r')
+            return;
+        is.Take();
+    }
+}
+
+template <typename InputStream>
+void json_to_yaml_impl(InputStream& is, std::ostream& sink)
+{
+    constexpr unsigned flags = rapidjson::kParseStopWhenDoneFlag |
+                               rapidjson::kParseNumbersAsStringsFlag;
+
+    yaml_emitting_handler handler{sink};
+    rapidjson::Reader reader;
+
+    for (std::size_t index = 0;; ++index)
+    {
+        skip_whitespace(is);
+        if (is.Peek() == '\0')
+            break;
+
+        handler.begin_document(index);
+        const rapidjson::ParseResult res = reader.Parse<flags>(is, handler);
+        if (res.Code() == rapidjson::kParseErrorTermination)
+            throw transcode_error{handler.error()};
+        if (!res)
+        {
+            throw json::parse_error{
+                std::string{rapidjson::GetParseError_En(res.Code())} +
+                " (at offset " + std::to_string(res.Offset()) + ")"};
+        }
+    }
+}
+} // namespace
+
+void yaml_to_json(std::istream& input, std::ostream& sink)
+{
+    json_writing_handler handler{sink};
+    try
+    {
+        YAML::Parser parser{input};
+        while (parser.HandleNextDocument(handler))
+            ;
+    }
+    catch (const YAML::Exception& ex)
+    {
+        throw yaml::parse_error{ex.what()};
+    }
+}
+
+void yaml_to_json(std::string_view input, std::ostream& sink)
+{
+    view_streambuf buf{input};
+    std::istream is{&buf};
+    yaml_to_json(is, sink);
+}
+
+std::string yaml_to_json(std::string_view input)
+{
+    std::ostringstream sink;
+    yaml_to_json(input, sink);
+    return sink.str();
+}
+
+void json_to_yaml(std::istream& input, std::ostream& sink)
+{
+    rapidjson::IStreamWrapper is{input};
+    json_to_yaml_impl(is, sink);
+}
+
+void json_to_yaml(std::string_view input, std::ostream& sink)
+{
+    rapidjson::MemoryStream is{input.data(), input.size()};
+    json_to_yaml_impl(is, sink);
+}
+
+std::string json_to_yaml(std::string_view input)
+{
+    std::ostringstream sink;
+    json_to_yaml(input, sink);
+    return sink.str();
+}
+} // namespace kl::transcode
@@ -1,7 +1,17 @@
 #include "kl/yaml.hpp"
 #include "kl/reflect_enum.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <exception>
 #include <iterator>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
 
 namespace YAML {
 
@@ -16,8 +26,512 @@ std::string type_name(const YAML::Node& value)
 {
     return kl::to_string(value.Type());
 }
+
+const std::shared_ptr<const void>*
+    alias_cache::find(const YAML::Node& node, const std::type_info& type) const
+{
+    const auto range = entries_.equal_range(node.Mark().pos);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        const auto& e = it->second;
+        if (*e.type == type && e.node.is(node))
+            return &e.object;
+    }
+    return nullptr;
+}
+
+void alias_cache::insert(const YAML::Node& node, const std::type_info& type,
+                         std::shared_ptr<const void> object)
+{
+    entries_.emplace(node.Mark().pos, entry{node, &type, std::move(object)});
+}
+
+namespace {
+
+thread_local alias_scope* current_alias_scope = nullptr;
+} // namespace
+
+alias_scope::alias_scope() noexcept : outermost_{!current_alias_scope}
+{
+    if (outermost_)
+        current_alias_scope = this;
+}
+
+alias_scope::~alias_scope()
+{
+    if (outermost_)
+        current_alias_scope = nullptr;
+}
+
+alias_cache* alias_scope::current_cache()
+{
+    if (!current_alias_scope)
+        return nullptr;
+    auto& cache = current_alias_scope->cache_;
+    if (!cache)
+        cache.emplace();
+    return &*cache;
+}
+
+namespace {
+
+// Mimics `(stream >> std::ws).eof()` check done by yaml-cpp after extraction
+std::string_view trim_trailing_space(std::string_view str) noexcept
+{
+    const auto last = str.find_last_not_of(" \t\n\v\f\r");
+    return last == std::string_view::npos ? std::string_view{}
+                                          : str.substr(0, last + 1);
+}
+
+bool is_lower(char ch) noexcept { return 'a' <= ch && ch <= 'z'; }
+bool is_upper(char ch) noexcept { return 'A' <= ch && ch <= 'Z'; }
+
+bool all_of(std::string_view str, bool (*pred)(char) noexcept) noexcept
+{
+    for (const char ch : str)
+    {
+        if (!pred(ch))
+            return false;
+    }
+    return true;
+}
+
+// Same as yaml-cpp's IsFlexibleCase: UPPERCASE, lowercase or Capitalized
+bool is_flexible_case(std::string_view str) noexcept
+{
+    if (str.empty() || all_of(str, is_lower))
+        return true;
+    const auto rest = str.substr(1);
+    return is_upper(str[0]) &&
+           (all_of(rest, is_lower) || all_of(rest, is_upper));
+}
+
+bool equals_lower(std::string_view str, std::string_view lower) noexcept
+{
+    if (str.size() != lower.size())
+        return false;
+    for (std::size_t i = 0; i < str.size(); ++i)
+    {
+        const char ch = is_upper(str[i]) ? str[i] - 'A' + 'a' : str[i];
+        if (ch != lower[i])
+            return false;
+    }
+    return true;
+}
+
+template <typename Integral>
+bool parse_integral(std::string_view str, Integral& out) noexcept
+{
+    using unsigned_type = std::make_unsigned_t<Integral>;
+
+    str = trim_trailing_space(str);
+    if (str.empty())
+        return false;
+
+    // yaml-cpp unsets std::ios::dec so the base is deduced from the prefix
+    // just like for strtol(str, nullptr, 0)
+    bool negative = false;
+    if (str[0] == '-' || str[0] == '+')
+    {
+        negative = str[0] == '-';
+        if (negative && std::is_unsigned_v<Integral>)
+            return false;
+        str.remove_prefix(1);
+    }
+
+    int base = 10;
+    if (str.size() > 1 && str[0] == '0')
+    {
+        if (str[1] == 'x' || str[1] == 'X')
+        {
+            base = 16;
+            str.remove_prefix(2);
+        }
+        else
+        {
+            base = 8;
+            str.remove_prefix(1);
+        }
+    }
+
+    unsigned_type magnitude{};
+    const auto end = str.data() + str.size();
+    const auto res = std::from_chars(str.data(), end, magnitude, base);
+    if (res.ec != std::errc{} || res.ptr != end)
+        return false;
+
+    if constexpr (std::is_signed_v<Integral>)
+    {
+        const auto limit =
+            static_cast<unsigned_type>((std::numeric_limits<Integral>::max)()) +
+            static_cast<unsigned_type>(negative);
+        if (magnitude > limit)
+            return false;
+        if (negative)
+            magnitude = static_cast<unsigned_type>(0U - magnitude);
+    }
+
+    out = static_cast<Integral>(magnitude);
+    return true;
+}
+
+template <typename Float>
+bool parse_floating_point_stream(std::string_view str, Float& out)
+{
+    std::stringstream stream{std::string{str}};
+    stream.unsetf(std::ios::dec);
+    return (stream >> std::noskipws >> out) && (stream >> std::ws).eof();
+}
+
+template <typename Float>
+bool parse_floating_point(std::string_view str, Float& out) noexcept
+{
+    // Special values are checked on the original input, as yaml-cpp does
+    if (str == ".inf" || str == ".Inf" || str == ".INF" || str == "+.inf" ||
+        str == "+.Inf" || str == "+.INF")
+    {
+        out = std::numeric_limits<Float>::infinity();
+        return true;
+    }
+    if (str == "-.inf" || str == "-.Inf" || str == "-.INF")
+    {
+        out = -std::numeric_limits<Float>::infinity();
+        return true;
+    }
+    if (str == ".nan" || str == ".NaN" || str == ".NAN")
+    {
+        out = std::numeric_limits<Float>::quiet_NaN();
+        return true;
+    }
+
+    const auto trimmed = trim_trailing_space(str);
+    auto number = trimmed;
+    bool negative = false;
+    if (!number.empty() && (number[0] == '-' || number[0] == '+'))
+    {
+        negative = number[0] == '-';
+        number.remove_prefix(1);
+    }
+
+    // Reject what std::from_chars would accept but operator>> would not
+    // (inf, nan, a second sign)
+    if (number.empty() ||
+        !((number[0] >= '0' && number[0] <= '9') || number[0] == '.'))
+    {
+        return false;
+    }
+
+#if defined(__cpp_lib_to_chars)
+    const auto end = number.data() + number.size();
+    const auto res = std::from_chars(number.data(), end, out);
+    if (res.ec == std::errc{})
+    {
+        if (res.ptr != end)
+            return false;
+        if (negative)
+            out = -out;
+        return true;
+    }
+    if (res.ec != std::errc::result_out_of_range)
+        return false;
+    // from_chars reports both overflow and underflow as out of range while
+    // the stream only rejects the former. Let it decide on such rare inputs.
+#else
+    (void)negative;
+#endif
+
+    try
+    {
+        return parse_floating_point_stream(trimmed, out);
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+enum class line_kind
+{
+    document_start,
+    document_end,
+    directive,
+    blank,
+    content
+};
+
+line_kind classify_line(std::string_view line) noexcept
+{
+    if (!line.empty() && line.back() == '\n')
+        line.remove_suffix(1);
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+
+    const auto is_marker = [line](char ch) {
+        return line.size() >= 3 && line[0] == ch && line[1] == ch &&
+               line[2] == ch &&
+               (line.size() == 3 || line[3] == ' ' || line[3] == '\t');
+    };
+
+    if (is_marker('-'))
+        return line_kind::document_start;
+    if (is_marker('.'))
+        return line_kind::document_end;
+    if (!line.empty() && line[0] == '%')
+        return line_kind::directive;
+
+    const auto first = line.find_first_not_of(" \t");
+    if (first == std::string_view::npos || line[first] == '#')
+        return line_kind::blank;
+    return line_kind::content;
+}
+} // namespace
+
+std::vector<std::string_view> split_documents(std::string_view text)
+{
+    std::vector<std::string_view> documents;
+
+    std::size_t document_begin = 0;
+    bool in_document = false;
+
+    for (std::size_t line_begin = 0; line_begin < text.size();)
+    {
+        auto line_end = text.find('\n', line_begin);
+        line_end = line_end == std::string_view::npos ? text.size()
+                                                      : line_end + 1;
+        const auto line = text.substr(line_begin, line_end - line_begin);
+
+        switch (classify_line(line))
+        {
+        case line_kind::document_start:
+            if (in_document)
+            {
+                documents.push_back(text.substr(
+                    document_begin, line_begin - document_begin));
+                document_begin = line_begin;
+            }
+            in_document = true;
+            break;
+        case line_kind::document_end:
+            if (in_document)
+            {
+                documents.push_back(
+                    text.substr(document_begin, line_end - document_begin));
+            }
+            in_document = false;
+            document_begin = line_end;
+            break;
+        case line_kind::content:
+            // Bare document (without leading `---`)
+            in_document = true;
+            break;
+        case line_kind::directive:
+        case line_kind::blank:
+            break;
+        }
+
+        line_begin = line_end;
+    }
+
+    if (in_document)
+        documents.push_back(text.substr(document_begin));
+
+    return documents;
+}
+
+YAML::Node load_document(std::string_view document, std::size_t index)
+{
+    try
+    {
+        return YAML::Load(std::string{document});
+    }
+    catch (const YAML::Exception& ex)
+    {
+        throw parse_error{std::string{ex.what()} +
+                          "\nerror when parsing document " +
+                          std::to_string(index)};
+    }
+}
+
+void parallel_for(std::size_t count, unsigned num_threads,
+                  const std::function<void(std::size_t)>& task)
+{
+    if (num_threads == 0)
+        num_threads = (std::max)(std::thread::hardware_concurrency(), 1U);
+    if (count < num_threads)
+        num_threads = static_cast<unsigned>(count);
+
+    if (num_threads <= 1)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            task(i);
+        return;
+    }
+
+    std::atomic<std::size_t> next_index{0};
+    // Tasks are picked in order so once it's set, all tasks with a lower
+    // index have already been started and will be run to completion
+    std::atomic<std::size_t> failed_index{count};
+    std::vector<std::exception_ptr> errors(count);
+
+    auto worker = [&] {
+        for (;;)
+        {
+            const auto index = next_index.fetch_add(1);
+            if (index >= failed_index.load())
+                return;
+
+            try
+            {
+                task(index);
+            }
+            catch (...)
+            {
+                errors[index] = std::current_exception();
+                auto failed = failed_index.load();
+                while (index < failed &&
+                       !failed_index.compare_exchange_weak(failed, index))
+                {
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads - 1);
+    for (unsigned i = 1; i < num_threads; ++i)
+    {
+        try
+        {
+            workers.emplace_back(worker);
+        }
+        catch (const std::system_error&)
+        {
+            // Carry on with the workers we already have
+            break;
+        }
+    }
+    worker();
+    for (auto& thread : workers)
+        thread.join();
+
+    if (const auto failed = failed_index.load(); failed < count)
+        std::rethrow_exception(errors[failed]);
+}
 } // namespace detail
 
+bool parse_scalar(std::string_view str, bool& out) noexcept
+{
+    // Same set of spellings as YAML::convert<bool>
+    static constexpr std::string_view names[][2] = {
+        {"y", "n"}, {"yes", "no"}, {"true", "false"}, {"on", "off"}};
+
+    if (!detail::is_flexible_case(str))
+        return false;
+
+    for (const auto& name : names)
+    {
+        if (detail::equals_lower(str, name[0]))
+        {
+            out = true;
+            return true;
+        }
+        if (detail::equals_lower(str, name[1]))
+        {
+            out = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parse_scalar(std::string_view str, signed char& out) noexcept
+{
+    return detail::parse_integral(str, out);
+}
+
+bool parse_scalar(std::string_view str, unsigned char& out) noexcept
+{
+    return detail::parse_integral(str, out);
+}
+
+bool parse_scalar(std::string_view str, short& out) noexcept
+{
+    return detail::parse_integral(str, out);
+}
+
+bool parse_scalar(std::string_view str, unsigned short& out) noexcept
+{
+    return detail::parse_integral(str, out);
+}
+
+bool parse_scalar(std::string_view str, int& out) noexcept
+{
+    return detail::parse_integral(str, out);
+}
+
+bool parse_scalar(std::string_view str, unsigned& out) noexcept
+{
+    return detail::parse_integral(str, out);
+}
+
+bool parse_scalar(std::string_view str, long& out) noexcept
+{
+    return detail::parse_integral(str, out);
+}
+
+bool parse_scalar(std::string_view str, unsigned long& out) noexcept
+{
+    return detail::parse_integral(str, out);
+}
+
+bool parse_scalar(std::string_view str, long long& out) noexcept
+{
+    return detail::parse_integral(str, out);
+}
+
+bool parse_scalar(std::string_view str, unsigned long long& out) noexcept
+{
+    return detail::parse_integral(str, out);
+}
+
+bool parse_scalar(std::string_view str, float& out) noexcept
+{
+    return detail::parse_floating_point(str, out);
+}
+
+bool parse_scalar(std::string_view str, double& out) noexcept
+{
+    return detail::parse_floating_point(str, out);
+}
+
+bool parse_scalar(std::string_view str, long double& out) noexcept
+{
+    return detail::parse_floating_point(str, out);
+}
+
+file_sink::file_sink(const char* file_path, std::size_t buffer_size)
+    : std::ostream{nullptr}, buffer_(buffer_size)
+{
+    // Must be called before open() to take effect
+    filebuf_.pubsetbuf(buffer_.data(),
+                       static_cast<std::streamsize>(buffer_.size()));
+    if (!filebuf_.open(file_path, std::ios::out | std::ios::trunc))
+        throw std::ios_base::failure{std::string{"can't open "} + file_path};
+    rdbuf(&filebuf_);
+}
+
+file_sink::~file_sink() = default;
+
+void file_sink::close()
+{
+    if (!filebuf_.is_open())
+        return;
+    if (!filebuf_.close() || fail())
+    {
+        setstate(std::ios::badbit);
+        throw std::ios_base::failure{"error while writing the file"};
+    }
+}
+
 void deserialize_error::add(const char* message)
 {
     messages_.insert(end(messages_), '\n');
@@ -0,0 +1,154 @@
+#include "kl/yaml_cache.hpp"
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace kl::yaml::detail {
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr std::uint32_t cache_magic = 0x4359'4C4B; // "KLYC"
+constexpr std::uint32_t cache_version = 1;
+constexpr std::size_t cache_header_size = 4 + 4 + 8 * 6;
+
+// 64-bit FNV-1a
+std::uint64_t hash_bytes(const void* data, std::size_t size) noexcept
+{
+    auto bytes = static_cast<const unsigned char*>(data);
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (std::size_t i = 0; i < size; ++i)
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    return hash;
+}
+
+std::uint64_t hash_bytes(gsl::span<const std::byte> bytes) noexcept
+{
+    return hash_bytes(bytes.data(), bytes.size_bytes());
+}
+
+std::uint64_t hash_string(const std::string& str) noexcept
+{
+    return hash_bytes(str.data(), str.size());
+}
+} // namespace
+
+cache_key make_cache_key(const std::string& path,
+                         gsl::span<const std::byte> contents,
+                         const std::string& type_schema)
+{
+    std::error_code ec;
+    const auto mtime = fs::last_write_time(path, ec);
+
+    cache_key key;
+    key.type_hash = hash_string(type_schema);
+    key.source_size = contents.size_bytes();
+    key.source_mtime = ec ? 0 : mtime.time_since_epoch().count();
+    key.source_hash = hash_bytes(contents);
+    return key;
+}
+
+std::string cache_file_path(const std::string& path,
+                            const std::string& cache_dir)
+{
+    std::error_code ec;
+    auto source = fs::absolute(path, ec);
+    if (ec)
+        source = path;
+
+    std::array<char, 17> hex{};
+    const auto path_hash = hash_string(source.string());
+    for (std::size_t i = 0; i < 16; ++i)
+        hex[i] = "0123456789abcdef"[(path_hash >> (60 - 4 * i)) & 0xF];
+
+    const auto name = source.stem().string() + '-' + hex.data() + ".klcache";
+    return (fs::path{cache_dir} / name).string();
+}
+
+std::optional<gsl::span<const std::byte>>
+    cached_payload(gsl::span<const std::byte> cache, const cache_key& key)
+{
+    binary_reader r{cache};
+
+    const auto magic = r.read<std::uint32_t>();
+    const auto version = r.read<std::uint32_t>();
+    const auto type_hash = r.read<std::uint64_t>();
+    const auto source_size = r.read<std::uint64_t>();
+    const auto source_mtime = r.read<std::int64_t>();
+    const auto source_hash = r.read<std::uint64_t>();
+    const auto payload_size = r.read<std::uint64_t>();
+    const auto payload_hash = r.read<std::uint64_t>();
+
+    if (r.err() || magic != cache_magic || version != cache_version ||
+        type_hash != key.type_hash || source_size != key.source_size ||
+        source_mtime != key.source_mtime || source_hash != key.source_hash ||
+        payload_size != r.left())
+    {
+        return std::nullopt;
+    }
+
+    const auto payload = r.span(r.left());
+    if (hash_bytes(payload) != payload_hash)
+        return std::nullopt;
+    return payload;
+}
+
+bool write_cache_file(const std::string& cache_path, const cache_key& key,
+                      gsl::span<const std::byte> payload)
+{
+    std::array<std::byte, cache_header_size> header;
+    binary_writer w{gsl::span<std::byte>{header}};
+    w << cache_magic << cache_version << key.type_hash << key.source_size
+      << key.source_mtime << key.source_hash
+      << static_cast<std::uint64_t>(payload.size_bytes())
+      << hash_bytes(payload);
+    if (w.err() || !w.empty())
+        return false;
+
+    const fs::path final_path{cache_path};
+    std::error_code ec;
+    fs::create_directories(final_path.parent_path(), ec);
+
+    // Never let a reader see a half-written cache
+    auto temp_path = final_path;
+    temp_path += ".tmp" + std::to_string(std::random_device{}());
+
+    {
+        std::ofstream file{temp_path, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<const char*>(header.data()),
+                   static_cast<std::streamsize>(header.size()));
+        file.write(reinterpret_cast<const char*>(payload.data()),
+                   static_cast<std::streamsize>(payload.size_bytes()));
+        file.close();
+        if (!file)
+        {
+            fs::remove(temp_path, ec);
+            return false;
+        }
+    }
+
+    fs::rename(temp_path, final_path, ec);
+    if (ec)
+    {
+        fs::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+YAML::Node load_source(gsl::span<const std::byte> contents)
+{
+    try
+    {
+        return YAML::Load(std::string{
+            reinterpret_cast<const char*>(contents.data()),
+            contents.size_bytes()});
+    }
+    catch (const YAML::Exception& ex)
+    {
+        throw parse_error{ex.what()};
+    }
+}
+} // namespace kl::yaml::detail
@@ -1,11 +1,28 @@
 #include "kl/binary_rw.hpp"
+#include "kl/binary_rw/array.hpp"
+#include "kl/binary_rw/binary_size.hpp"
+#include "kl/binary_rw/columnar.hpp"
+#include "kl/binary_rw/delta.hpp"
+#include "kl/binary_rw/deque.hpp"
 #include "kl/binary_rw/endian.hpp"
+#include "kl/binary_rw/flat_map.hpp"
+#include "kl/binary_rw/flat_set.hpp"
+#include "kl/binary_rw/framed.hpp"
+#include "kl/binary_rw/gather_writer.hpp"
+#include "kl/binary_rw/growable_writer.hpp"
 #include "kl/binary_rw/map.hpp"
 #include "kl/binary_rw/optional.hpp"
+#include "kl/binary_rw/record_file.hpp"
+#include "kl/binary_rw/reflectable.hpp"
 #include "kl/binary_rw/set.hpp"
+#include "kl/binary_rw/stream_reader.hpp"
 #include "kl/binary_rw/string.hpp"
+#include "kl/binary_rw/unordered_map.hpp"
+#include "kl/binary_rw/unordered_set.hpp"
 #include "kl/binary_rw/variant.hpp"
+#include "kl/binary_rw/varint.hpp"
 #include "kl/binary_rw/vector.hpp"
+#include "kl/reflect_struct.hpp"
 
 #include <catch2/catch_test_macros.hpp>
 #include <gsl/span>
@@ -13,7 +30,9 @@
 #include <gsl/span_ext> // operator==
 
 #include <cstring>
+#include <fstream>
 #include <optional>
+#include <sstream>
 
 static constexpr inline std::byte operator"" _b(unsigned long long i)
 {
@@ -147,6 +166,33 @@ TEST_CASE("binary_reader - map")
         REQUIRE(!r.err());
         REQUIRE(r.empty());
     }
+    SECTION("duplicated keys")
+    {
+        std::array<std::byte, 4 + 3 * 2> buf = {3_b, 0_b, 0_b, 0_b, 1_b,
+                                                10_b, 2_b, 20_b, 1_b, 30_b};
+        binary_reader r{buf};
+
+        // First one wins, like with insert()
+        auto ret = r.read<std::map<std::uint8_t, std::uint8_t>>();
+        REQUIRE(ret == std::map<std::uint8_t, std::uint8_t>{{1, 10}, {2, 20}});
+        REQUIRE(!r.err());
+        REQUIRE(r.empty());
+    }
+
+    SECTION("round trip")
+    {
+        std::map<int, std::string> map;
+        for (int i = 0; i < 1000; ++i)
+            map.emplace(i * 7 % 1000, std::to_string(i));
+
+        kl::growable_binary_writer w;
+        w << map;
+        const auto buf = w.finalize();
+        binary_reader r{buf};
+        REQUIRE(r.read<std::map<int, std::string>>() == map);
+        REQUIRE(r.empty());
+        REQUIRE(!r.err());
+    }
 }
 
 TEST_CASE("binary_reader - set")
@@ -184,6 +230,17 @@ TEST_CASE("binary_reader - set")
         REQUIRE(!r.err());
         REQUIRE(r.empty());
     }
+    SECTION("out of order and duplicated elems")
+    {
+        std::array<std::byte, 4 + 5> buf = {5_b, 0_b, 0_b, 0_b, 1_b,
+                                            3_b, 2_b, 3_b, 0_b};
+        binary_reader r{buf};
+
+        auto ret = r.read<std::set<std::byte>>();
+        REQUIRE(ret == std::set<std::byte>{0_b, 1_b, 2_b, 3_b});
+        REQUIRE(!r.err());
+        REQUIRE(r.empty());
+    }
 }
 
 TEST_CASE("binary_reader - optional")
@@ -329,6 +386,140 @@ TEST_CASE("binary_reader - variant")
         REQUIRE(std::get<std::string>(ret) == "Hello, world!      ");
         REQUIRE(r.empty());
     }
+    SECTION("same alternative is read in place")
+    {
+        std::array<std::byte, 1 + 4 + 2> buf = {1_b,   2_b, 0_b, 0_b,
+                                                0_b, 'a'_b, 'b'_b};
+        binary_reader r{buf};
+
+        variant var{std::string(100, 'x')};
+        const auto* data = std::get<std::string>(var).data();
+        read_variant_in_place(r, var);
+        REQUIRE(!r.err());
+        REQUIRE(std::get<std::string>(var) == "ab");
+        REQUIRE(std::get<std::string>(var).data() == data);
+    }
+
+    SECTION("failed read leaves variant unchanged")
+    {
+        std::array<std::byte, 1 + 4 + 1> buf = {1_b, 2_b, 0_b, 0_b, 0_b, 'a'_b};
+        binary_reader r{buf};
+
+        variant var{19};
+        REQUIRE(!r.read(var));
+        REQUIRE(std::get<boost::endian::little_int32_t>(var) == 19);
+
+        r = binary_reader{buf};
+        read_variant_in_place(r, var);
+        REQUIRE(r.err());
+        REQUIRE(var.index() == 1);
+    }
+}
+
+using wide_variant = std::variant<std::uint8_t, std::string>;
+
+template <>
+struct kl::variant_tag<wide_variant>
+{
+    using type = std::uint16_t;
+};
+
+template <std::size_t I>
+struct indexed
+{
+    std::uint8_t value;
+};
+
+template <std::size_t I>
+void write_binary(kl::binary_writer& w, const indexed<I>& v)
+{
+    w << v.value;
+}
+
+template <std::size_t I>
+void read_binary(kl::binary_reader& r, indexed<I>& v)
+{
+    r >> v.value;
+}
+
+template <std::size_t... Is>
+auto make_big_variant(std::index_sequence<Is...>)
+    -> std::variant<indexed<Is>...>;
+
+TEST_CASE("binary_reader/writer - variant tags")
+{
+    using variant_256 =
+        decltype(make_big_variant(std::make_index_sequence<256>{}));
+    using variant_257 =
+        decltype(make_big_variant(std::make_index_sequence<257>{}));
+    static_assert(
+        std::is_same_v<kl::variant_tag_t<variant_256>, std::uint8_t>);
+    static_assert(
+        std::is_same_v<kl::variant_tag_t<variant_257>, std::uint16_t>);
+
+    SECTION("8-bit tag")
+    {
+        std::array<std::byte, 1 + 1> buf{};
+        kl::binary_writer w{buf};
+        w << variant_256{std::in_place_index<255>, indexed<255>{7}};
+        REQUIRE(w.empty());
+        REQUIRE(!w.err());
+        REQUIRE(buf[0] == 255_b);
+
+        kl::binary_reader r{buf};
+        const auto var = r.read<variant_256>();
+        REQUIRE(var.index() == 255);
+        REQUIRE(std::get<255>(var).value == 7);
+        REQUIRE(r.empty());
+        REQUIRE(!r.err());
+    }
+
+    SECTION("16-bit tag chosen automatically")
+    {
+        std::array<std::byte, 2 + 1> buf{};
+        kl::binary_writer w{buf};
+        w << variant_257{std::in_place_index<256>, indexed<256>{7}};
+        REQUIRE(w.empty());
+        REQUIRE(!w.err());
+
+        kl::binary_reader r{buf};
+        REQUIRE(r.read<std::uint16_t>() == 256);
+
+        r = kl::binary_reader{buf};
+        const auto var = r.read<variant_257>();
+        REQUIRE(var.index() == 256);
+        REQUIRE(std::get<256>(var).value == 7);
+        REQUIRE(r.empty());
+        REQUIRE(!r.err());
+
+        buf[0] = 1_b;
+        buf[1] = 1_b;
+        r = kl::binary_reader{buf};
+        r.read<variant_257>();
+        REQUIRE(r.err());
+    }
+
+    SECTION("16-bit tag by specialization")
+    {
+        std::array<std::byte, 2 + 4 + 3> buf{};
+        kl::binary_writer w{buf};
+        w << wide_variant{std::string{"abc"}};
+        REQUIRE(w.empty());
+        REQUIRE(!w.err());
+
+        kl::binary_reader r{buf};
+        REQUIRE(r.read<std::uint16_t>() == 1);
+
+        r = kl::binary_reader{buf};
+        REQUIRE(std::get<std::string>(r.read<wide_variant>()) == "abc");
+        REQUIRE(r.empty());
+        REQUIRE(!r.err());
+
+        buf[0] = 2_b;
+        r = kl::binary_reader{buf};
+        r.read<wide_variant>();
+        REQUIRE(r.err());
+    }
 }
 
 TEST_CASE("binary_reader - vector")
@@ -617,6 +808,17 @@ TEST_CASE("binary_writer - set")
         REQUIRE(!r.err());
         REQUIRE(r.empty());
     }
+    SECTION("out of order and duplicated elems")
+    {
+        std::array<std::byte, 4 + 5> buf = {5_b, 0_b, 0_b, 0_b, 1_b,
+                                            3_b, 2_b, 3_b, 0_b};
+        binary_reader r{buf};
+
+        auto ret = r.read<std::set<std::byte>>();
+        REQUIRE(ret == std::set<std::byte>{0_b, 1_b, 2_b, 3_b});
+        REQUIRE(!r.err());
+        REQUIRE(r.empty());
+    }
 }
 
 TEST_CASE("binary_writer - optional")
@@ -842,3 +1044,1787 @@ TEST_CASE("binary_reader/writer - user defined type")
     REQUIRE(v[1].i == 55);
     REQUIRE(v[1].f == 10000.0f);
 }
+
+struct reflectable_type
+{
+    std::uint16_t id;
+    std::string name;
+    std::vector<float> values;
+};
+KL_REFLECT_STRUCT(reflectable_type, id, name, values)
+
+TEST_CASE("binary_reader/writer - reflectable type")
+{
+    std::array<std::byte, 2 + 4 + 3 + 4 + 8> buf{};
+    kl::binary_writer w{buf};
+
+    w << reflectable_type{7, "abc", {1.0f, 2.0f}};
+    REQUIRE(w.empty());
+    REQUIRE(!w.err());
+
+    kl::binary_reader r{buf};
+    REQUIRE(r.read<std::uint16_t>() == 7);
+    REQUIRE(r.read<std::string>() == "abc");
+
+    r = kl::binary_reader{buf};
+    auto ret = r.read<reflectable_type>();
+    REQUIRE(r.empty());
+    REQUIRE(!r.err());
+    REQUIRE(ret.id == 7);
+    REQUIRE(ret.name == "abc");
+    REQUIRE(ret.values == std::vector<float>{1.0f, 2.0f});
+
+    SECTION("buffer too short")
+    {
+        kl::binary_reader short_r{gsl::span{buf.data(), buf.size() - 1}};
+        short_r.read<reflectable_type>();
+        REQUIRE(short_r.err());
+    }
+}
+
+struct packed_type
+{
+    std::uint32_t id;
+    float value;
+    std::uint16_t a, b;
+};
+KL_REFLECT_STRUCT(packed_type, id, value, a, b)
+
+struct nested_packed_type
+{
+    packed_type inner;
+    std::uint32_t tag;
+};
+KL_REFLECT_STRUCT(nested_packed_type, inner, tag)
+
+struct padded_type
+{
+    std::uint8_t a;
+    std::uint32_t b;
+};
+KL_REFLECT_STRUCT(padded_type, a, b)
+
+struct reordered_type
+{
+    std::uint32_t a;
+    std::uint16_t b, c;
+};
+KL_REFLECT_STRUCT(reordered_type, b, a, c)
+
+TEST_CASE("binary_reader/writer - packed reflectable type")
+{
+    using kl::detail::is_packed_reflectable_candidate;
+    static_assert(is_packed_reflectable_candidate<packed_type>());
+    static_assert(is_packed_reflectable_candidate<nested_packed_type>());
+    static_assert(!is_packed_reflectable_candidate<padded_type>());
+    static_assert(is_packed_reflectable_candidate<reordered_type>());
+    static_assert(!is_packed_reflectable_candidate<reflectable_type>());
+
+    REQUIRE(kl::detail::is_packed_reflectable(packed_type{}));
+    REQUIRE(kl::detail::is_packed_reflectable(nested_packed_type{}));
+    REQUIRE(!kl::detail::is_packed_reflectable(reordered_type{}));
+
+    // Same bytes as writing fields one by one
+    const auto write_fields = [](kl::binary_writer& w, const packed_type& p) {
+        w << p.id << p.value << p.a << p.b;
+    };
+
+    SECTION("packed")
+    {
+        std::array<std::byte, 12> buf{}, expected{};
+        kl::binary_writer w{buf}, we{expected};
+        const packed_type p{7, 2.5f, 3, 4};
+        w << p;
+        write_fields(we, p);
+        REQUIRE(w.empty());
+        REQUIRE(!w.err());
+        REQUIRE(buf == expected);
+
+        kl::binary_reader r{buf};
+        const auto ret = r.read<packed_type>();
+        REQUIRE(r.empty());
+        REQUIRE(!r.err());
+        REQUIRE(ret.id == 7);
+        REQUIRE(ret.value == 2.5f);
+        REQUIRE(ret.a == 3);
+        REQUIRE(ret.b == 4);
+
+        kl::binary_reader short_r{gsl::span{buf.data(), buf.size() - 1}};
+        short_r.read<packed_type>();
+        REQUIRE(short_r.err());
+    }
+
+    SECTION("nested")
+    {
+        std::array<std::byte, 16> buf{}, expected{};
+        kl::binary_writer w{buf}, we{expected};
+        const nested_packed_type n{{1, 0.5f, 2, 3}, 0x11223344};
+        w << n;
+        write_fields(we, n.inner);
+        we << n.tag;
+        REQUIRE(!w.err());
+        REQUIRE(buf == expected);
+
+        kl::binary_reader r{buf};
+        const auto ret = r.read<nested_packed_type>();
+        REQUIRE(!r.err());
+        REQUIRE(ret.inner.id == 1);
+        REQUIRE(ret.inner.b == 3);
+        REQUIRE(ret.tag == 0x11223344);
+    }
+
+    SECTION("padded and reordered types are written field by field")
+    {
+        std::array<std::byte, 5 + 8> buf{};
+        kl::binary_writer w{buf};
+        w << padded_type{1, 2} << reordered_type{3, 4, 5};
+        REQUIRE(w.empty());
+        REQUIRE(!w.err());
+
+        kl::binary_reader r{buf};
+        REQUIRE(r.read<std::uint8_t>() == 1);
+        REQUIRE(r.read<std::uint32_t>() == 2);
+        REQUIRE(r.read<std::uint16_t>() == 4);
+        REQUIRE(r.read<std::uint32_t>() == 3);
+        REQUIRE(r.read<std::uint16_t>() == 5);
+
+        r = kl::binary_reader{buf};
+        const auto padded = r.read<padded_type>();
+        const auto reordered = r.read<reordered_type>();
+        REQUIRE(r.empty());
+        REQUIRE(!r.err());
+        REQUIRE(padded.a == 1);
+        REQUIRE(padded.b == 2);
+        REQUIRE(reordered.a == 3);
+        REQUIRE(reordered.b == 4);
+        REQUIRE(reordered.c == 5);
+    }
+
+    SECTION("vectors are written as one span")
+    {
+        std::vector<packed_type> vec;
+        for (std::uint32_t i = 0; i < 10; ++i)
+            vec.push_back({i, 0.5f * i, static_cast<std::uint16_t>(i), 7});
+
+        // Big spans are referenced by the gather writer, not copied
+        kl::gather_binary_writer w{16};
+        w << vec;
+        REQUIRE(!w.err());
+        const auto segments = w.segments();
+        REQUIRE(segments.size() == 2);
+        REQUIRE(segments[1].data() ==
+                reinterpret_cast<const std::byte*>(vec.data()));
+        REQUIRE(segments[1].size() == vec.size() * sizeof(packed_type));
+
+        const auto buf = w.finalize();
+        kl::binary_reader r{buf};
+        const auto ret = r.read<std::vector<packed_type>>();
+        REQUIRE(r.empty());
+        REQUIRE(!r.err());
+        REQUIRE(ret.size() == vec.size());
+        REQUIRE(std::memcmp(ret.data(), vec.data(),
+                            vec.size() * sizeof(packed_type)) == 0);
+
+        // Reordered fields still go one by one
+        kl::gather_binary_writer w2{16};
+        w2 << std::vector<reordered_type>{{1, 2, 3}, {4, 5, 6}};
+        REQUIRE(w2.segments().size() == 1);
+        const auto buf2 = w2.finalize();
+        r = kl::binary_reader{buf2};
+        const auto reordered = r.read<std::vector<reordered_type>>();
+        REQUIRE(!r.err());
+        REQUIRE(reordered.size() == 2);
+        REQUIRE(reordered[1].c == 6);
+    }
+}
+
+struct opt_in_type
+{
+    std::uint32_t a, b;
+};
+
+static int opt_in_type_writes = 0;
+
+void write_binary(kl::binary_writer& w, const opt_in_type& value)
+{
+    ++opt_in_type_writes;
+    w.write_raw(value);
+}
+
+void read_binary(kl::binary_reader& r, opt_in_type& value)
+{
+    r.read_raw(value);
+}
+
+template <>
+struct kl::is_trivially_serializable<opt_in_type> : std::true_type
+{
+};
+
+struct array_field_type
+{
+    std::array<float, 3> pos;
+    boost::endian::big_uint32_t id;
+};
+KL_REFLECT_STRUCT(array_field_type, pos, id)
+
+TEST_CASE("binary_reader/writer - trivially serializable types")
+{
+    using boost::endian::big_uint16_t;
+    using kl::is_trivially_serializable_v;
+
+    static_assert(is_trivially_serializable_v<std::uint16_t>);
+    static_assert(is_trivially_serializable_v<std::array<float, 3>>);
+    static_assert(
+        is_trivially_serializable_v<std::array<std::array<int, 2>, 2>>);
+    static_assert(is_trivially_serializable_v<big_uint16_t>);
+    static_assert(is_trivially_serializable_v<opt_in_type>);
+    static_assert(!is_trivially_serializable_v<std::array<std::string, 2>>);
+    static_assert(!is_trivially_serializable_v<packed_type>);
+    static_assert(
+        kl::detail::is_packed_reflectable_candidate<array_field_type>());
+
+    SECTION("std::array")
+    {
+        std::array<std::byte, 8 + 4 + 1 + 4 + 1> buf{};
+        kl::binary_writer w{buf};
+        w << std::array<big_uint16_t, 4>{1, 2, 3, 4}
+          << std::array<std::string, 2>{"a", "b"};
+        REQUIRE(w.empty());
+        REQUIRE(!w.err());
+        REQUIRE(buf[0] == 0_b);
+        REQUIRE(buf[1] == 1_b);
+
+        kl::binary_reader r{buf};
+        REQUIRE(r.read<std::array<big_uint16_t, 4>>() ==
+                std::array<big_uint16_t, 4>{1, 2, 3, 4});
+        REQUIRE(r.read<std::array<std::string, 2>>() ==
+                std::array<std::string, 2>{"a", "b"});
+        REQUIRE(r.empty());
+        REQUIRE(!r.err());
+
+        r = kl::binary_reader{gsl::span{buf.data(), 7}};
+        r.read<std::array<big_uint16_t, 4>>();
+        REQUIRE(r.err());
+    }
+
+    SECTION("vector of arrays")
+    {
+        const std::vector<std::array<float, 3>> vec{{1, 2, 3}, {4, 5, 6}};
+        std::array<std::byte, 4 + 2 * 12> buf{};
+        kl::binary_writer w{buf};
+        w << vec;
+        REQUIRE(w.empty());
+        REQUIRE(!w.err());
+
+        kl::binary_reader r{buf};
+        REQUIRE(r.read<std::vector<std::array<float, 3>>>() == vec);
+        REQUIRE(!r.err());
+    }
+
+    SECTION("user opt-in")
+    {
+        std::array<std::byte, 4 + 3 * 8> buf{};
+        kl::binary_writer w{buf};
+        opt_in_type_writes = 0;
+        w << std::vector<opt_in_type>{{1, 2}, {3, 4}, {5, 6}};
+        REQUIRE(w.empty());
+        REQUIRE(!w.err());
+        // Went in one piece
+        REQUIRE(opt_in_type_writes == 0);
+
+        kl::binary_reader r{buf};
+        const auto ret = r.read<std::vector<opt_in_type>>();
+        REQUIRE(!r.err());
+        REQUIRE(ret.size() == 3);
+        REQUIRE(ret[2].a == 5);
+        REQUIRE(ret[2].b == 6);
+    }
+
+    SECTION("reflectable with array and endian fields")
+    {
+        std::array<std::byte, 16> buf{};
+        kl::binary_writer w{buf};
+        w << array_field_type{{1, 2, 3}, 0x01020304};
+        REQUIRE(w.empty());
+        REQUIRE(buf[12] == 1_b);
+
+        kl::binary_reader r{buf};
+        const auto ret = r.read<array_field_type>();
+        REQUIRE(!r.err());
+        REQUIRE(ret.pos == std::array<float, 3>{1, 2, 3});
+        REQUIRE(ret.id == 0x01020304U);
+    }
+}
+
+TEST_CASE("binary_reader/writer - varint")
+{
+    using kl::varint;
+
+    const auto encode = [](auto value) {
+        kl::growable_binary_writer w;
+        w << value;
+        return w.finalize();
+    };
+    const auto bytes = [](std::initializer_list<int> list) {
+        std::vector<std::byte> ret;
+        for (const auto b : list)
+            ret.push_back(static_cast<std::byte>(b));
+        return ret;
+    };
+
+    SECTION("encoding")
+    {
+        REQUIRE(encode(varint<std::uint32_t>{0}) == bytes({0}));
+        REQUIRE(encode(varint<std::uint32_t>{127}) == bytes({0x7F}));
+        REQUIRE(encode(varint<std::uint32_t>{128}) == bytes({0x80, 0x01}));
+        REQUIRE(encode(varint<std::uint16_t>{300}) == bytes({0xAC, 0x02}));
+        REQUIRE(encode(varint<std::uint64_t>{UINT64_MAX}) ==
+                bytes({0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                       0x01}));
+
+        // zigzag
+        REQUIRE(encode(varint<std::int32_t>{0}) == bytes({0}));
+        REQUIRE(encode(varint<std::int32_t>{-1}) == bytes({1}));
+        REQUIRE(encode(varint<std::int32_t>{1}) == bytes({2}));
+        REQUIRE(encode(varint<std::int32_t>{-64}) == bytes({0x7F}));
+        REQUIRE(encode(varint<std::int32_t>{64}) == bytes({0x80, 0x01}));
+        REQUIRE(encode(varint<std::int8_t>{INT8_MIN}) == bytes({0xFF, 0x01}));
+        REQUIRE(encode(varint<std::int32_t>{INT32_MIN}) ==
+                bytes({0xFF, 0xFF, 0xFF, 0xFF, 0x0F}));
+    }
+
+    SECTION("round trip")
+    {
+        const std::vector<std::int64_t> values{
+            0, 1, -1, 63, -64, 64, 1000000, -1000000, INT64_MAX, INT64_MIN};
+
+        for (const auto value : values)
+        {
+            const auto buf = encode(varint<std::int64_t>{value});
+            // Big enough buffer (fast path) and exact one (slow path)
+            auto padded = buf;
+            padded.resize(buf.size() + 10);
+            for (const auto& b : {buf, padded})
+            {
+                kl::binary_reader r{b};
+                REQUIRE(r.read<varint<std::int64_t>>() == value);
+                REQUIRE(r.pos() == buf.size());
+                REQUIRE(!r.err());
+            }
+        }
+
+        const auto buf = encode(varint<std::uint8_t>{255});
+        kl::binary_reader r{buf};
+        REQUIRE(r.read<varint<std::uint8_t>>() == 255);
+    }
+
+    SECTION("invalid")
+    {
+        // Truncated
+        auto buf = bytes({0x80, 0x80});
+        kl::binary_reader r{buf};
+        r.read<varint<std::uint32_t>>();
+        REQUIRE(r.err());
+
+        // Overflow
+        buf = bytes({0x80, 0x02});
+        r = kl::binary_reader{buf};
+        r.read<varint<std::uint8_t>>();
+        REQUIRE(r.err());
+
+        // Too long, with and without the fast path
+        buf = bytes({0x80, 0x80, 0x80, 0x80, 0x80, 0x00});
+        r = kl::binary_reader{buf};
+        r.read<varint<std::uint32_t>>();
+        REQUIRE(r.err());
+        buf.resize(16);
+        r = kl::binary_reader{buf};
+        r.read<varint<std::uint32_t>>();
+        REQUIRE(r.err());
+    }
+
+    SECTION("length prefixes")
+    {
+        kl::growable_binary_writer w;
+        w.set_prefix_format(kl::length_format::varint);
+        w << std::string{"abc"} << std::vector<std::uint8_t>(200, 1)
+          << std::map<int, std::set<int>>{{1, {2}}};
+        REQUIRE(!w.err());
+        REQUIRE(w.size() == 1 + 3 + 2 + 200 + 1 + 4 + 1 + 4);
+
+        const auto buf = w.finalize();
+        kl::binary_reader r{buf};
+        r.set_prefix_format(kl::length_format::varint);
+        REQUIRE(r.read<std::string>() == "abc");
+        REQUIRE(r.read<std::vector<std::uint8_t>>().size() == 200);
+        REQUIRE(r.read<std::map<int, std::set<int>>>() ==
+                std::map<int, std::set<int>>{{1, {2}}});
+        REQUIRE(r.empty());
+        REQUIRE(!r.err());
+    }
+
+    SECTION("stream")
+    {
+        const auto buf = encode(varint<std::uint64_t>{std::uint64_t{1} << 40});
+        std::size_t offset = 0;
+        kl::stream_binary_reader r{[&](gsl::span<std::byte> out) {
+            if (offset == buf.size())
+                return std::size_t{0};
+            out[0] = buf[offset++];
+            return std::size_t{1};
+        }};
+        REQUIRE(r.read<varint<std::uint64_t>>() == std::uint64_t{1} << 40);
+        REQUIRE(!r.err());
+        REQUIRE(r.at_end());
+    }
+}
+
+TEST_CASE("binary_size")
+{
+    using kl::binary_size;
+
+    static_assert(binary_size<std::uint16_t>() == 2);
+    static_assert(binary_size<std::array<float, 3>>() == 12);
+    static_assert(binary_size<packed_type>() == 12);
+    static_assert(binary_size<std::array<packed_type, 2>>() == 24);
+    static_assert(binary_size(std::uint64_t{5}) == 8);
+    static_assert(!kl::has_fixed_binary_size_v<padded_type>);
+    static_assert(!kl::has_fixed_binary_size_v<std::string>);
+
+    SECTION("variable size")
+    {
+        REQUIRE(binary_size(std::string{"abc"}) == 4 + 3);
+        REQUIRE(binary_size(padded_type{}) == 5);
+        REQUIRE(binary_size(std::vector<std::uint32_t>(1000)) == 4 + 4000);
+        REQUIRE(binary_size(std::vector<std::string>{"a", "bc"}) ==
+                4 + 4 + 1 + 4 + 2);
+        REQUIRE(binary_size(reflectable_type{7, "abc", {1.0f, 2.0f}}) ==
+                2 + 4 + 3 + 4 + 8);
+        REQUIRE(binary_size(std::string{"abc"}, kl::length_format::varint) ==
+                1 + 3);
+    }
+
+    SECTION("serialize_to_vector")
+    {
+        const reflectable_type value{7, "abc", {1.0f, 2.0f}};
+        const auto buf = kl::serialize_to_vector(value);
+        REQUIRE(buf.size() == binary_size(value));
+
+        kl::binary_reader r{buf};
+        const auto ret = r.read<reflectable_type>();
+        REQUIRE(r.empty());
+        REQUIRE(!r.err());
+        REQUIRE(ret.name == "abc");
+        REQUIRE(ret.values == value.values);
+
+        const auto varint_buf =
+            kl::serialize_to_vector(value, kl::length_format::varint);
+        REQUIRE(varint_buf.size() == 2 + 1 + 3 + 1 + 8);
+    }
+}
+
+struct record_view
+{
+    std::uint32_t id;
+    std::string_view name;
+    gsl::span<const std::uint16_t> values;
+};
+KL_REFLECT_STRUCT(record_view, id, name, values)
+
+TEST_CASE("binary_reader - views")
+{
+    alignas(8) std::array<std::byte, 64> buf{};
+
+    SECTION("string_view")
+    {
+        kl::binary_writer w{buf};
+        w << std::string_view{"abc"} << std::string{} << std::string{"de"};
+        REQUIRE(!w.err());
+
+        kl::binary_reader r{buf};
+        const auto a = r.read<std::string_view>();
+        REQUIRE(a == "abc");
+        REQUIRE(reinterpret_cast<const std::byte*>(a.data()) == &buf[4]);
+        REQUIRE(r.read<std::string_view>().empty());
+        REQUIRE(r.read<std::string>() == "de");
+        REQUIRE(!r.err());
+
+        r = kl::binary_reader{gsl::span{buf.data(), 6}};
+        REQUIRE(r.read<std::string_view>().empty());
+        REQUIRE(r.err());
+    }
+
+    SECTION("span")
+    {
+        kl::binary_writer w{buf};
+        w << std::vector<std::uint32_t>{1, 2, 3}
+          << std::vector<boost::endian::big_uint16_t>{4, 5};
+        REQUIRE(!w.err());
+
+        kl::binary_reader r{buf};
+        const auto a = r.read<gsl::span<const std::uint32_t>>();
+        REQUIRE(a.size() == 3);
+        REQUIRE(a[2] == 3);
+        REQUIRE(reinterpret_cast<const std::byte*>(a.data()) == &buf[4]);
+        const auto b = r.read<gsl::span<const boost::endian::big_uint16_t>>();
+        REQUIRE(b.size() == 2);
+        REQUIRE(b[1] == 5);
+        REQUIRE(r.pos() == 4 + 12 + 4 + 4);
+        REQUIRE(!r.err());
+
+        // Truncated
+        r = kl::binary_reader{gsl::span{buf.data(), 15}};
+        REQUIRE(r.read<gsl::span<const std::uint32_t>>().empty());
+        REQUIRE(r.err());
+    }
+
+    SECTION("misaligned span")
+    {
+        kl::binary_writer w{buf};
+        w << std::uint8_t{0} << std::vector<std::uint32_t>{1, 2, 3};
+
+        kl::binary_reader r{buf};
+        r.skip(1);
+        REQUIRE(r.read<gsl::span<const std::uint32_t>>().empty());
+        REQUIRE(r.err());
+    }
+
+    SECTION("reflectable")
+    {
+        kl::binary_writer w{buf};
+        w << std::uint32_t{7} << std::string{"name"}
+          << std::vector<std::uint16_t>{1, 2};
+
+        kl::binary_reader r{buf};
+        const auto rec = r.read<record_view>();
+        REQUIRE(!r.err());
+        REQUIRE(rec.id == 7);
+        REQUIRE(rec.name == "name");
+        REQUIRE(rec.values.size() == 2);
+        REQUIRE(rec.values[1] == 2);
+    }
+}
+
+TEST_CASE("binary_reader/writer - other containers")
+{
+    kl::growable_binary_writer w;
+
+    SECTION("unordered_map")
+    {
+        const std::unordered_map<std::string, int> map{
+            {"a", 1}, {"b", 2}, {"c", 3}};
+        w << map;
+        const auto buf = w.finalize();
+        REQUIRE(buf.size() == 4 + 3 * (4 + 1 + 4));
+
+        kl::binary_reader r{buf};
+        REQUIRE(r.read<std::unordered_map<std::string, int>>() == map);
+        REQUIRE(r.empty());
+        REQUIRE(!r.err());
+
+        r = kl::binary_reader{gsl::span{buf.data(), buf.size() - 1}};
+        REQUIRE(r.read<std::unordered_map<std::string, int>>().empty());
+        REQUIRE(r.err());
+    }
+
+    SECTION("unordered_set")
+    {
+        const std::unordered_set<int> set{1, 2, 3, 4};
+        w << set;
+        const auto buf = w.finalize();
+
+        kl::binary_reader r{buf};
+        REQUIRE(r.read<std::unordered_set<int>>() == set);
+        REQUIRE(r.empty());
+        REQUIRE(!r.err());
+    }
+
+    SECTION("deque")
+    {
+        const std::deque<std::string> deq{"a", "bc", ""};
+        w << deq;
+        const auto buf = w.finalize();
+
+        kl::binary_reader r{buf};
+        REQUIRE(r.read<std::deque<std::string>>() == deq);
+        REQUIRE(r.empty());
+        REQUIRE(!r.err());
+    }
+
+    SECTION("flat_map")
+    {
+        using flat_map = boost::container::flat_map<int, std::string>;
+        const flat_map map{{1, "a"}, {2, "b"}, {5, "c"}};
+        w << map;
+        const auto buf = w.finalize();
+
+        kl::binary_reader r{buf};
+        REQUIRE(r.read<flat_map>() == map);
+        REQUIRE(r.empty());
+        REQUIRE(!r.err());
+
+        // Same format as std::map
+        r = kl::binary_reader{buf};
+        REQUIRE(r.read<std::map<int, std::string>>() ==
+                std::map<int, std::string>{{1, "a"}, {2, "b"}, {5, "c"}});
+    }
+
+    SECTION("flat_map - unsorted input")
+    {
+        w << std::uint32_t{4} << 5 << std::string{"c"} << 1
+          << std::string{"a"} << 5 << std::string{"d"} << 2
+          << std::string{"b"};
+        const auto buf = w.finalize();
+
+        kl::binary_reader r{buf};
+        const auto map = r.read<boost::container::flat_map<int, std::string>>();
+        REQUIRE(!r.err());
+        REQUIRE(map.size() == 3);
+        REQUIRE(map.begin()->first == 1);
+        REQUIRE(map.at(2) == "b");
+        REQUIRE(map.rbegin()->first == 5);
+    }
+
+    SECTION("flat_map - duplicated keys")
+    {
+        // First of duplicated keys wins, same as with std::map
+        w << std::uint32_t{60};
+        for (int i = 59; i >= 0; --i)
+            w << i % 3 << i;
+        const auto buf = w.finalize();
+
+        kl::binary_reader r{buf};
+        const auto map = r.read<boost::container::flat_map<int, int>>();
+        REQUIRE(!r.err());
+        REQUIRE(map.size() == 3);
+        REQUIRE(map.at(0) == 57);
+        REQUIRE(map.at(1) == 58);
+        REQUIRE(map.at(2) == 59);
+
+        r = kl::binary_reader{buf};
+        for (const auto& kv : r.read<std::map<int, int>>())
+            REQUIRE(map.at(kv.first) == kv.second);
+    }
+
+    SECTION("flat_set")
+    {
+        using flat_set = boost::container::flat_set<int>;
+        w << flat_set{3, 1, 2};
+        w << std::vector<int>{3, 1, 3, 2};
+        const auto buf = w.finalize();
+
+        kl::binary_reader r{buf};
+        REQUIRE(r.read<flat_set>() == flat_set{1, 2, 3});
+        REQUIRE(r.read<flat_set>() == flat_set{1, 2, 3});
+        REQUIRE(r.empty());
+        REQUIRE(!r.err());
+    }
+}
+
+TEST_CASE("binary_reader - hostile length prefixes")
+{
+    using kl::min_binary_size_v;
+
+    static_assert(min_binary_size_v<std::uint32_t> == 4);
+    static_assert(min_binary_size_v<std::string> == 1);
+    static_assert(min_binary_size_v<std::pair<std::uint16_t, std::string>> ==
+                  3);
+    static_assert(min_binary_size_v<std::array<std::uint64_t, 2>> == 16);
+    static_assert(min_binary_size_v<packed_type> == 12);
+    static_assert(min_binary_size_v<reflectable_type> == 1);
+
+    SECTION("claims exceeding the data")
+    {
+        // Claims 4G elements
+        std::array<std::byte, 12> buf = {0xFF_b, 0xFF_b, 0xFF_b, 0xFF_b};
+
+        kl::binary_reader r{buf};
+        REQUIRE(r.read<std::vector<std::uint32_t>>().capacity() == 0);
+        REQUIRE(r.err());
+
+        r = kl::binary_reader{buf};
+        REQUIRE(r.read<std::vector<std::string>>().capacity() == 0);
+        REQUIRE(r.err());
+
+        r = kl::binary_reader{buf};
+        REQUIRE(r.read<std::string>().capacity() <= std::string{}.capacity());
+        REQUIRE(r.err());
+
+        r = kl::binary_reader{buf};
+        REQUIRE(r.read<std::unordered_set<int>>().bucket_count() < 16);
+        REQUIRE(r.err());
+
+        // 2 elements of at least 4 bytes need 8 bytes, there are 7
+        buf = {2_b, 0_b, 0_b, 0_b, 1_b, 0_b, 0_b, 0_b, 2_b, 0_b, 0_b};
+        r = kl::binary_reader{gsl::span{buf.data(), 11}};
+        r.read<std::vector<std::uint32_t>>();
+        REQUIRE(r.err());
+        r = kl::binary_reader{gsl::span{buf.data(), 11}};
+        r.read<std::map<std::uint32_t, std::string>>();
+        REQUIRE(r.err());
+        r = kl::binary_reader{gsl::span{buf.data(), 11}};
+        r.read<std::vector<std::string>>();
+        REQUIRE(r.err());
+    }
+
+    SECTION("allocation budget")
+    {
+        kl::growable_binary_writer w;
+        w << std::vector<std::uint32_t>(10) << std::vector<std::uint32_t>(20)
+          << std::string(50, 'x');
+        const auto buf = w.finalize();
+
+        kl::binary_reader r{buf};
+        r.set_alloc_budget(100);
+        REQUIRE(r.read<std::vector<std::uint32_t>>().size() == 10);
+        REQUIRE(r.alloc_budget() == 60);
+        REQUIRE(!r.err());
+        REQUIRE(r.read<std::vector<std::uint32_t>>().empty());
+        REQUIRE(r.alloc_budget() == 60);
+        REQUIRE(r.err());
+
+        r = kl::binary_reader{buf};
+        r.set_alloc_budget(200);
+        r.skip(4 + 40 + 4 + 80);
+        REQUIRE(r.read<std::string>().size() == 50);
+        REQUIRE(r.alloc_budget() == 150);
+    }
+
+    SECTION("stream")
+    {
+        // Can't tell how much data there is, only the budget helps
+        std::array<std::byte, 4> buf = {0xFF_b, 0xFF_b, 0xFF_b, 0x0F_b};
+        std::size_t offset = 0;
+        kl::stream_binary_reader r{[&](gsl::span<std::byte> out) {
+            const auto count = (std::min)(out.size(), buf.size() - offset);
+            std::memcpy(out.data(), buf.data() + offset, count);
+            offset += count;
+            return count;
+        }};
+        r.set_alloc_budget(1 << 20);
+        REQUIRE(r.read<std::vector<std::uint32_t>>().empty());
+        REQUIRE(r.err());
+    }
+
+    SECTION("stream without a budget")
+    {
+        // Claims 256M elements but has only a few, containers must grow with
+        // the data instead of trusting the prefix
+        std::vector<std::byte> buf = {0xFF_b, 0xFF_b, 0xFF_b, 0x0F_b};
+        buf.resize(64, 1_b);
+        std::size_t offset = 0;
+        auto make_reader = [&] {
+            offset = 0;
+            return kl::stream_binary_reader{[&](gsl::span<std::byte> out) {
+                const auto count = (std::min)(out.size(), buf.size() - offset);
+                std::memcpy(out.data(), buf.data() + offset, count);
+                offset += count;
+                return count;
+            }};
+        };
+        const std::size_t max_capacity = 64 * 1024;
+
+        {
+            auto r = make_reader();
+            const auto vec = r.read<std::vector<std::uint32_t>>();
+            REQUIRE(r.err());
+            REQUIRE(vec.capacity() <= max_capacity / 4);
+        }
+        {
+            auto r = make_reader();
+            const auto vec = r.read<std::vector<std::string>>();
+            REQUIRE(r.err());
+            REQUIRE(vec.capacity() * sizeof(std::string) <= max_capacity);
+        }
+        {
+            auto r = make_reader();
+            const auto str = r.read<std::string>();
+            REQUIRE(r.err());
+            REQUIRE(str.capacity() <= max_capacity);
+        }
+        {
+            auto r = make_reader();
+            std::vector<packed_type> vec;
+            kl::read_columnar(r, vec);
+            REQUIRE(r.err());
+            REQUIRE(vec.capacity() * sizeof(packed_type) <= max_capacity);
+        }
+        {
+            // First value and then blocks with zero width
+            buf[4] = 0_b;
+            std::fill(buf.begin() + 5, buf.end(), 0_b);
+            auto r = make_reader();
+            std::vector<std::int64_t> vec;
+            kl::read_delta(r, vec);
+            REQUIRE(r.err());
+            REQUIRE(vec.capacity() * sizeof(std::int64_t) <= max_capacity);
+        }
+    }
+}
+
+TEST_CASE("binary_reader/writer - bulk endian conversion")
+{
+    using boost::endian::order;
+
+    SECTION("byte_swap")
+    {
+        // Covers the vectorized part and the tail for all lengths
+        for (std::size_t count = 0; count < 70; ++count)
+        {
+            std::vector<std::uint16_t> v16(count);
+            std::vector<std::uint32_t> v32(count);
+            std::vector<std::uint64_t> v64(count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                v16[i] = static_cast<std::uint16_t>(0x0102 + i);
+                v32[i] = static_cast<std::uint32_t>(0x01020304 + i);
+                v64[i] = 0x0102030405060708 + i;
+            }
+
+            kl::detail::byte_swap(v16.data(), count);
+            kl::detail::byte_swap(v32.data(), count);
+            kl::detail::byte_swap(v64.data(), count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                REQUIRE(v16[i] == boost::endian::endian_reverse(
+                                      static_cast<std::uint16_t>(0x0102 + i)));
+                REQUIRE(v32[i] ==
+                        boost::endian::endian_reverse(
+                            static_cast<std::uint32_t>(0x01020304 + i)));
+                REQUIRE(v64[i] == boost::endian::endian_reverse(
+                                      std::uint64_t{0x0102030405060708 + i}));
+            }
+        }
+    }
+
+    SECTION("same as endian_arithmetic")
+    {
+        std::vector<std::int32_t> samples(5000);
+        for (std::size_t i = 0; i < samples.size(); ++i)
+            samples[i] = static_cast<std::int32_t>(i * 7919) - 20000;
+
+        kl::growable_binary_writer w, expected;
+        kl::write_endian<order::big>(w, gsl::span{samples});
+        for (const auto sample : samples)
+            expected << boost::endian::big_int32_t{sample};
+        REQUIRE(!w.err());
+        REQUIRE(w.finalize() == expected.finalize());
+
+        const auto buf = w.finalize();
+        kl::binary_reader r{buf};
+        std::vector<std::int32_t> ret(samples.size());
+        kl::read_endian<order::big>(r, gsl::span{ret});
+        REQUIRE(!r.err());
+        REQUIRE(r.empty());
+        REQUIRE(ret == samples);
+    }
+
+    SECTION("native order")
+    {
+        const std::vector<std::int16_t> samples{1, -2, 3};
+        std::array<std::byte, 6> buf{};
+        kl::binary_writer w{buf};
+        kl::write_endian<order::native>(w, gsl::span{samples});
+
+        kl::binary_reader r{buf};
+        REQUIRE(r.read<std::int16_t>() == 1);
+        REQUIRE(r.read<std::int16_t>() == -2);
+
+        r = kl::binary_reader{buf};
+        std::array<std::int16_t, 3> ret{};
+        kl::read_endian<order::native>(r, gsl::span{ret});
+        REQUIRE(ret == std::array<std::int16_t, 3>{1, -2, 3});
+    }
+
+    SECTION("buffer too short")
+    {
+        const std::vector<std::uint64_t> samples(10, 1);
+        std::array<std::byte, 79> buf{};
+        kl::binary_writer w{buf};
+        kl::write_endian<order::little>(w, gsl::span{samples});
+        REQUIRE(w.err());
+
+        kl::binary_reader r{buf};
+        std::vector<std::uint64_t> ret(10, 5);
+        kl::read_endian<order::big>(r, gsl::span{ret});
+        REQUIRE(r.err());
+        REQUIRE(ret == std::vector<std::uint64_t>(10, 5));
+    }
+}
+
+struct telemetry_sample
+{
+    std::uint64_t timestamp;
+    std::uint16_t sensor;
+    float value;
+    std::string unit;
+};
+KL_REFLECT_STRUCT(telemetry_sample, timestamp, sensor, value, unit)
+
+struct telemetry_batch
+{
+    std::uint32_t id;
+    kl::columnar<std::vector<telemetry_sample>> samples;
+};
+KL_REFLECT_STRUCT(telemetry_batch, id, samples)
+
+TEST_CASE("binary_reader/writer - columnar")
+{
+    using namespace kl;
+
+    std::vector<telemetry_sample> samples;
+    for (std::uint16_t i = 0; i < 1000; ++i)
+    {
+        samples.push_back({1000000u + i, static_cast<std::uint16_t>(i % 7),
+                           i * 0.5f, i % 2 ? "C" : "kPa"});
+    }
+
+    SECTION("fields are written column by column")
+    {
+        const std::vector<telemetry_sample> vec{{1, 2, 3.0f, "a"},
+                                                {4, 5, 6.0f, "bc"}};
+        std::array<std::byte, 4 + 16 + 4 + 8 + 4 + 1 + 4 + 2> buf{};
+        binary_writer w{buf};
+        write_columnar(w, vec);
+        REQUIRE(w.empty());
+        REQUIRE(!w.err());
+
+        binary_reader r{buf};
+        REQUIRE(r.read<std::uint32_t>() == 2);
+        REQUIRE(r.read<std::uint64_t>() == 1);
+        REQUIRE(r.read<std::uint64_t>() == 4);
+        REQUIRE(r.read<std::uint16_t>() == 2);
+        REQUIRE(r.read<std::uint16_t>() == 5);
+        REQUIRE(r.read<float>() == 3.0f);
+        REQUIRE(r.read<float>() == 6.0f);
+        REQUIRE(r.read<std::string>() == "a");
+        REQUIRE(r.read<std::string>() == "bc");
+        REQUIRE(r.empty());
+    }
+
+    SECTION("round trip")
+    {
+        // Bigger than one chunk
+        growable_binary_writer w;
+        write_columnar(w, samples);
+        REQUIRE(!w.err());
+
+        const auto buffer = w.finalize();
+        binary_reader r{buffer};
+        std::vector<telemetry_sample> ret;
+        read_columnar(r, ret);
+        REQUIRE(!r.err());
+        REQUIRE(r.empty());
+        REQUIRE(ret.size() == samples.size());
+        for (std::size_t i = 0; i < ret.size(); ++i)
+        {
+            REQUIRE(ret[i].timestamp == samples[i].timestamp);
+            REQUIRE(ret[i].sensor == samples[i].sensor);
+            REQUIRE(ret[i].value == samples[i].value);
+            REQUIRE(ret[i].unit == samples[i].unit);
+        }
+    }
+
+    SECTION("columnar field")
+    {
+        growable_binary_writer w;
+        w << telemetry_batch{7, samples} << std::uint8_t{42};
+
+        const auto buffer = w.finalize();
+        binary_reader r{buffer};
+        const auto batch = r.read<telemetry_batch>();
+        REQUIRE(batch.id == 7);
+        REQUIRE(batch.samples.value().size() == samples.size());
+        REQUIRE(batch.samples.value().back().unit == "C");
+        REQUIRE(r.read<std::uint8_t>() == 42);
+        REQUIRE(!r.err());
+    }
+
+    SECTION("empty")
+    {
+        std::array<std::byte, 4> buf{};
+        binary_writer w{buf};
+        write_columnar(w, std::vector<telemetry_sample>{});
+        REQUIRE(w.empty());
+
+        binary_reader r{buf};
+        std::vector<telemetry_sample> ret(3);
+        read_columnar(r, ret);
+        REQUIRE(!r.err());
+        REQUIRE(ret.empty());
+    }
+
+    SECTION("truncated")
+    {
+        growable_binary_writer w;
+        write_columnar(w, samples);
+        const auto buffer = w.finalize();
+
+        binary_reader r{gsl::span{buffer.data(), buffer.size() - 1}};
+        std::vector<telemetry_sample> ret;
+        read_columnar(r, ret);
+        REQUIRE(r.err());
+        REQUIRE(ret.empty());
+    }
+}
+
+TEST_CASE("binary_reader/writer - delta encoding")
+{
+    using namespace kl;
+
+    auto round_trip = [](const auto& vec) {
+        growable_binary_writer w;
+        write_delta(w, vec);
+        REQUIRE(!w.err());
+
+        const auto buffer = w.finalize();
+        binary_reader r{buffer};
+        std::remove_const_t<std::remove_reference_t<decltype(vec)>> ret;
+        read_delta(r, ret);
+        REQUIRE(!r.err());
+        REQUIRE(r.empty());
+        REQUIRE(ret == vec);
+        return buffer.size();
+    };
+
+    SECTION("regular intervals")
+    {
+        std::vector<std::int64_t> vec;
+        for (std::int64_t i = 0; i < 1000; ++i)
+            vec.push_back(1700000000000 + i * 1000);
+
+        // One value, then 8 blocks with a zero-bit frame each
+        REQUIRE(round_trip(vec) == 4 + 6 + 8 * (1 + 2));
+    }
+
+    SECTION("jitter is bit-packed")
+    {
+        std::vector<std::uint32_t> vec;
+        std::uint32_t value = 5;
+        for (std::uint32_t i = 0; i < 129; ++i)
+        {
+            vec.push_back(value);
+            value += 10 + i % 16;
+        }
+
+        // 4-bit offsets from 10 in one full block
+        REQUIRE(round_trip(vec) == 4 + 1 + 1 + 1 + 128 * 4 / 8);
+    }
+
+    SECTION("outliers fall back to varints")
+    {
+        std::vector<std::uint64_t> vec;
+        std::uint64_t value = 0;
+        for (std::uint64_t i = 0; i < 300; ++i)
+        {
+            vec.push_back(value);
+            value += i == 100 ? std::uint64_t{1} << 40 : 1;
+        }
+
+        const auto size = round_trip(vec);
+        REQUIRE(size < 4 + 1 + 3 * 128 * 2);
+    }
+
+    SECTION("unsorted and extreme values")
+    {
+        round_trip(std::vector<std::int32_t>{
+            0, -1, (std::numeric_limits<std::int32_t>::min)(),
+            (std::numeric_limits<std::int32_t>::max)(), 5, 5, -7});
+        round_trip(std::vector<std::uint64_t>{
+            (std::numeric_limits<std::uint64_t>::max)(), 0, 1,
+            std::uint64_t{1} << 63});
+        round_trip(std::vector<std::int8_t>{-128, 127, 0, 1, 2, 3});
+        round_trip(std::vector<std::uint16_t>{});
+        round_trip(std::vector<std::uint16_t>{42});
+
+        std::vector<std::uint64_t> vec;
+        for (std::uint64_t i = 0; i < 1000; ++i)
+            vec.push_back(i * i * i * i * 0x9e3779b97f4a7c15);
+        round_trip(vec);
+    }
+
+    SECTION("all widths")
+    {
+        for (unsigned width = 0; width <= 56; ++width)
+        {
+            std::vector<std::uint64_t> vec{0};
+            for (std::uint64_t i = 0; i < 250; ++i)
+            {
+                const auto mask = (std::uint64_t{1} << width) - 1;
+                vec.push_back(vec.back() + ((i * 0x9e3779b97f4a7c15) & mask));
+            }
+            round_trip(vec);
+        }
+    }
+
+    SECTION("delta_encoded field")
+    {
+        const delta_encoded<std::vector<std::int64_t>> value{
+            std::vector<std::int64_t>{10, 20, 30}};
+        growable_binary_writer w;
+        w << value << std::uint8_t{42};
+
+        const auto buffer = w.finalize();
+        binary_reader r{buffer};
+        REQUIRE(r.read<delta_encoded<std::vector<std::int64_t>>>().value() ==
+                value.value());
+        REQUIRE(r.read<std::uint8_t>() == 42);
+    }
+
+    SECTION("hostile input")
+    {
+        std::vector<std::uint32_t> vec(1000, 7);
+        growable_binary_writer w;
+        write_delta(w, vec);
+        auto buffer = w.finalize();
+
+        SECTION("truncated")
+        {
+            binary_reader r{gsl::span{buffer.data(), buffer.size() - 1}};
+            std::vector<std::uint32_t> ret;
+            read_delta(r, ret);
+            REQUIRE(r.err());
+            REQUIRE(ret.empty());
+        }
+
+        SECTION("count too big")
+        {
+            buffer[3] = 0x7f_b;
+            binary_reader r{buffer};
+            std::vector<std::uint32_t> ret;
+            read_delta(r, ret);
+            REQUIRE(r.err());
+            REQUIRE(ret.capacity() == 0);
+        }
+
+        SECTION("bad block width")
+        {
+            buffer[4 + 1] = 33_b;
+            binary_reader r{buffer};
+            std::vector<std::uint32_t> ret;
+            read_delta(r, ret);
+            REQUIRE(r.err());
+            REQUIRE(ret.empty());
+        }
+    }
+}
+
+TEST_CASE("growable_binary_writer")
+{
+    using namespace kl;
+
+    binary_block_pool pool{16};
+    growable_binary_writer w{pool};
+    REQUIRE(w.size() == 0);
+    REQUIRE(w.segments().empty());
+    REQUIRE(w.finalize().empty());
+
+    SECTION("spans multiple blocks")
+    {
+        const std::vector<std::uint32_t> vec{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+        const std::string str{"abcdefghijklmnopqrstuvwxyz"};
+        w << std::uint8_t{7} << vec << str << std::uint64_t{0x1122334455667788};
+        REQUIRE(!w.err());
+        REQUIRE(w.size() == 1 + 4 + 40 + 4 + 26 + 8);
+
+        const auto segments = w.segments();
+        REQUIRE(segments.size() == 6);
+        for (std::size_t i = 0; i + 1 < segments.size(); ++i)
+            REQUIRE(segments[i].size() == 16);
+        REQUIRE(segments.back().size() == w.size() - 5 * 16);
+
+        const auto buffer = w.finalize();
+        REQUIRE(buffer.size() == w.size());
+
+        binary_reader r{buffer};
+        REQUIRE(r.read<std::uint8_t>() == 7);
+        REQUIRE(r.read<std::vector<std::uint32_t>>() == vec);
+        REQUIRE(r.read<std::string>() == str);
+        REQUIRE(r.read<std::uint64_t>() == 0x1122334455667788);
+        REQUIRE(r.empty());
+        REQUIRE(!r.err());
+    }
+
+    SECTION("blocks are reused")
+    {
+        w << std::string(40, 'x');
+        REQUIRE(w.segments().size() == 3);
+        REQUIRE(pool.num_free() == 0);
+
+        w.clear();
+        REQUIRE(w.size() == 0);
+        REQUIRE(pool.num_free() == 3);
+
+        w << std::uint32_t{42};
+        REQUIRE(pool.num_free() == 2);
+        REQUIRE(w.finalize().size() == 4);
+
+        {
+            growable_binary_writer other{pool};
+            other << std::string(20, 'y');
+            REQUIRE(pool.num_free() == 0);
+        }
+        REQUIRE(pool.num_free() == 2);
+    }
+
+    SECTION("clear resets the error state")
+    {
+        w.notify_error();
+        w << std::uint32_t{1};
+        REQUIRE(w.err());
+        REQUIRE(w.size() == 0);
+
+        w.clear();
+        w << std::uint32_t{1};
+        REQUIRE(!w.err());
+        REQUIRE(w.size() == 4);
+    }
+
+    SECTION("own pool")
+    {
+        growable_binary_writer own;
+        own << std::vector<double>(1000, 0.5);
+        REQUIRE(!own.err());
+        REQUIRE(own.size() == 4 + 8000);
+        REQUIRE(own.segments().size() == 2);
+    }
+}
+
+TEST_CASE("framed_writer/framed_reader")
+{
+    using namespace kl;
+
+    const reflectable_type first{7, "abc", {1.0f, 2.0f}};
+    const std::string second(10000, 'x');
+
+    growable_binary_writer out;
+    {
+        framed_writer fw{out, 64};
+        REQUIRE(fw.write(first));
+        auto& w = fw.begin();
+        w << second;
+        REQUIRE(fw.commit());
+    }
+    REQUIRE(!out.err());
+    const auto data = out.finalize();
+
+    SECTION("frame layout")
+    {
+        binary_reader r{data};
+        const auto header = r.read<std::uint32_t>();
+        REQUIRE(header == 2 + 4 + 3 + 4 + 8);
+        const auto checksum = r.read<std::uint32_t>();
+        REQUIRE(checksum == crc32c(r.span(header)));
+    }
+
+    SECTION("round trip")
+    {
+        binary_reader r{data};
+        framed_reader fr{r};
+
+        reflectable_type ret1;
+        REQUIRE(fr.read(ret1));
+        REQUIRE(ret1.id == 7);
+        REQUIRE(ret1.values == first.values);
+
+        auto frame = fr.next();
+        REQUIRE(frame);
+        REQUIRE(frame->read<std::string>() == second);
+        REQUIRE(r.empty());
+
+        REQUIRE(!fr.next());
+        REQUIRE(r.err());
+        REQUIRE(!fr.checksum_error());
+    }
+
+    SECTION("stream reader")
+    {
+        std::size_t offset = 0;
+        stream_binary_reader r{
+            [&](gsl::span<std::byte> buffer) {
+                const auto count =
+                    (std::min)(buffer.size(), data.size() - offset);
+                std::memcpy(buffer.data(), data.data() + offset, count);
+                offset += count;
+                return count;
+            },
+            128};
+        framed_reader fr{r};
+
+        reflectable_type ret1;
+        std::string ret2;
+        REQUIRE(fr.read(ret1));
+        // Doesn't fit in the stream's buffer
+        REQUIRE(fr.read(ret2));
+        REQUIRE(ret2 == second);
+        REQUIRE(r.at_end());
+    }
+
+    SECTION("corrupted frame")
+    {
+        auto copy = data;
+        copy[8 + 3] ^= 0x01_b;
+        binary_reader r{copy};
+        framed_reader fr{r};
+
+        reflectable_type ret;
+        REQUIRE(!fr.read(ret));
+        REQUIRE(fr.checksum_error());
+        REQUIRE(r.err());
+    }
+
+    SECTION("message doesn't take the whole frame")
+    {
+        binary_reader r{data};
+        framed_reader fr{r};
+        std::uint16_t ret;
+        REQUIRE(!fr.read(ret));
+        REQUIRE(!fr.checksum_error());
+        REQUIRE(r.err());
+    }
+
+    SECTION("frame bigger than the budget")
+    {
+        binary_reader r{data};
+        r.set_alloc_budget(1000);
+        framed_reader fr{r};
+
+        reflectable_type ret1;
+        REQUIRE(fr.read(ret1));
+        REQUIRE(r.alloc_budget() < 1000);
+        std::string ret2;
+        REQUIRE(!fr.read(ret2));
+    }
+
+    SECTION("frame bigger than max_frame_size")
+    {
+        binary_reader r{data};
+        framed_reader fr{r, 1000};
+
+        reflectable_type ret1;
+        REQUIRE(fr.read(ret1));
+        std::string ret2;
+        REQUIRE(!fr.read(ret2));
+        REQUIRE(r.err());
+    }
+
+    SECTION("forged frame size on a stream")
+    {
+        // Claims 4 GiB, without a budget only max_frame_size stops it from
+        // being allocated
+        std::vector<std::byte> forged = {0xFF_b, 0xFF_b, 0xFF_b, 0xFF_b,
+                                         0_b,    0_b,    0_b,    0_b};
+        forged.resize(64, 1_b);
+        std::size_t offset = 0;
+        stream_binary_reader r{[&](gsl::span<std::byte> buffer) {
+            const auto count =
+                (std::min)(buffer.size(), forged.size() - offset);
+            std::memcpy(buffer.data(), forged.data() + offset, count);
+            offset += count;
+            return count;
+        }};
+        framed_reader fr{r};
+
+        REQUIRE(!fr.next());
+        REQUIRE(r.err());
+        REQUIRE(!fr.checksum_error());
+    }
+
+    SECTION("failed message isn't written")
+    {
+        std::array<std::byte, 8> buf{};
+        binary_writer w{buf};
+        framed_writer fw{w};
+        auto& scratch = fw.begin();
+        scratch << std::uint32_t{1};
+        scratch.notify_error();
+        REQUIRE(!fw.commit());
+        REQUIRE(w.err());
+        REQUIRE(w.pos() == 0);
+    }
+}
+
+TEST_CASE("gather_binary_writer")
+{
+    using namespace kl;
+
+    binary_block_pool pool{64};
+    gather_binary_writer w{pool, 32};
+    REQUIRE(w.threshold() == 32);
+    REQUIRE(w.size() == 0);
+    REQUIRE(w.segments().empty());
+
+    const std::vector<std::uint8_t> blob(100, 0xab);
+    const std::string small{"abc"};
+
+    SECTION("big spans are referenced")
+    {
+        w << std::uint32_t{7} << blob << small << blob
+          << std::uint64_t{0x1122334455667788};
+        REQUIRE(!w.err());
+        REQUIRE(w.size() == 4 + 4 + 100 + 4 + 3 + 4 + 100 + 8);
+
+        // Copied fields around the blobs share one block
+        const auto segments = w.segments();
+        REQUIRE(segments.size() == 5);
+        REQUIRE(segments[0].size() == 8);
+        REQUIRE(segments[1].data() ==
+                reinterpret_cast<const std::byte*>(blob.data()));
+        REQUIRE(segments[1].size() == 100);
+        REQUIRE(segments[2].size() == 4 + 3 + 4);
+        REQUIRE(segments[2].data() == segments[0].data() + 8);
+        REQUIRE(segments[3].data() == segments[1].data());
+        REQUIRE(segments[4].size() == 8);
+        REQUIRE(pool.num_free() == 0);
+
+        const auto buffer = w.finalize();
+        binary_reader r{buffer};
+        REQUIRE(r.read<std::uint32_t>() == 7);
+        REQUIRE(r.read<std::vector<std::uint8_t>>() == blob);
+        REQUIRE(r.read<std::string>() == small);
+        REQUIRE(r.read<std::vector<std::uint8_t>>() == blob);
+        REQUIRE(r.read<std::uint64_t>() == 0x1122334455667788);
+        REQUIRE(r.empty());
+    }
+
+    SECTION("small spans are copied across blocks")
+    {
+        gather_binary_writer own{32, 16};
+        const std::vector<std::uint32_t> vec{1, 2, 3, 4, 5, 6, 7};
+        own << vec;
+        REQUIRE(own.size() == 4 + 28);
+        const auto segments = own.segments();
+        REQUIRE(segments.size() == 2);
+        REQUIRE(segments[0].size() == 16);
+        REQUIRE(segments[1].size() == 16);
+
+        const auto buffer = own.finalize();
+        binary_reader r{buffer};
+        REQUIRE(r.read<std::vector<std::uint32_t>>() == vec);
+    }
+
+    SECTION("temporaries are copied")
+    {
+        const std::vector<std::uint16_t> vec(100, 0x0102);
+        write_endian<boost::endian::order::big>(w, gsl::span{vec});
+        REQUIRE(w.size() == 200);
+        for (const auto segment : w.segments())
+            REQUIRE(segment.size() <= 64);
+
+        const auto buffer = w.finalize();
+        REQUIRE(buffer[0] == 0x01_b);
+        REQUIRE(buffer[1] == 0x02_b);
+    }
+
+    SECTION("clear")
+    {
+        w << std::uint32_t{1} << blob;
+        w.clear();
+        REQUIRE(w.size() == 0);
+        REQUIRE(w.segments().empty());
+        REQUIRE(pool.num_free() == 1);
+
+        w.notify_error();
+        w << blob;
+        REQUIRE(w.size() == 0);
+    }
+}
+
+TEST_CASE("stream_binary_reader")
+{
+    using namespace kl;
+
+    const std::vector<std::uint32_t> vec{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    const std::string str(100, 'x');
+
+    growable_binary_writer w;
+    w << std::uint8_t{7} << vec << str << std::uint64_t{0x1122334455667788};
+    const auto data = w.finalize();
+
+    // Hands out at most 3 bytes at a time
+    std::size_t offset = 0;
+    std::size_t num_calls = 0;
+    auto chunked_source = [&](gsl::span<std::byte> buffer) {
+        ++num_calls;
+        const auto count =
+            (std::min)({buffer.size(), data.size() - offset, std::size_t{3}});
+        std::memcpy(buffer.data(), data.data() + offset, count);
+        offset += count;
+        return count;
+    };
+
+    SECTION("reads across refills")
+    {
+        stream_binary_reader r{chunked_source, 16};
+        REQUIRE(!r.at_end());
+        REQUIRE(r.read<std::uint8_t>() == 7);
+        REQUIRE(r.read<std::vector<std::uint32_t>>() == vec);
+        REQUIRE(r.read<std::string>() == str);
+        REQUIRE(r.peek<std::uint64_t>() == 0x1122334455667788);
+        REQUIRE(r.read<std::uint64_t>() == 0x1122334455667788);
+        REQUIRE(!r.err());
+        REQUIRE(r.at_end());
+        REQUIRE(!r.err());
+    }
+
+    SECTION("span")
+    {
+        stream_binary_reader r{chunked_source, 16};
+        r.read<std::uint8_t>();
+        r.read<std::vector<std::uint32_t>>();
+        r.read<std::uint32_t>();
+        REQUIRE(!r.err());
+        const auto s = r.span(16);
+        REQUIRE(s.size() == 16);
+        REQUIRE(s[0] == 'x'_b);
+        REQUIRE(s[15] == 'x'_b);
+
+        // Bigger than the buffer
+        REQUIRE(r.span(17).empty());
+        REQUIRE(r.err());
+    }
+
+    SECTION("big reads bypass the buffer")
+    {
+        stream_binary_reader r{chunked_source, 16};
+        r.read<std::uint8_t>();
+        r.read<std::vector<std::uint32_t>>();
+        const auto calls_before = num_calls;
+        REQUIRE(r.read<std::string>() == str);
+        // One call per 3 bytes, no extra calls to fill the buffer in between
+        REQUIRE(num_calls - calls_before <= (100 + 4) / 3 + 2);
+    }
+
+    SECTION("source runs dry")
+    {
+        auto truncated = [&](gsl::span<std::byte> buffer) {
+            const auto count =
+                (std::min)(buffer.size(), data.size() - 4 - offset);
+            std::memcpy(buffer.data(), data.data() + offset, count);
+            offset += count;
+            return count;
+        };
+
+        stream_binary_reader r{truncated, 16};
+        REQUIRE(r.read<std::uint8_t>() == 7);
+        REQUIRE(r.read<std::vector<std::uint32_t>>() == vec);
+        REQUIRE(r.read<std::string>() == str);
+        REQUIRE(!r.err());
+        r.read<std::uint64_t>();
+        REQUIRE(r.err());
+    }
+
+    SECTION("throwing source")
+    {
+        stream_binary_reader r{[](gsl::span<std::byte>) -> std::size_t {
+            throw std::runtime_error{"boom"};
+        }};
+        REQUIRE(r.at_end());
+        r.read<std::uint32_t>();
+        REQUIRE(r.err());
+    }
+
+    SECTION("istream doesn't wait for a full buffer")
+    {
+        // Hands out 3 bytes per underflow, like a pipe with small writes
+        struct chunked_buf : std::streambuf
+        {
+            explicit chunked_buf(const std::vector<std::byte>& data)
+                : data_{data}
+            {
+            }
+
+            int_type underflow() override
+            {
+                if (offset_ == data_.size())
+                    return traits_type::eof();
+                ++num_underflows;
+
+                auto* begin = const_cast<char*>(
+                    reinterpret_cast<const char*>(data_.data()) + offset_);
+                const auto count =
+                    (std::min)(std::size_t{3}, data_.size() - offset_);
+                offset_ += count;
+                setg(begin, begin, begin + count);
+                return traits_type::to_int_type(*begin);
+            }
+
+            const std::vector<std::byte>& data_;
+            std::size_t offset_{0};
+            int num_underflows{0};
+        };
+
+        chunked_buf buf{data};
+        std::istream is{&buf};
+        stream_binary_reader r{istream_source(is), 1024};
+        REQUIRE(r.read<std::uint8_t>() == 7);
+        REQUIRE(buf.num_underflows == 1);
+        REQUIRE(r.read<std::vector<std::uint32_t>>() == vec);
+        REQUIRE(buf.num_underflows < 20);
+    }
+
+    SECTION("istream")
+    {
+        std::istringstream is{std::string{
+            reinterpret_cast<const char*>(data.data()), data.size()}};
+        stream_binary_reader r{istream_source(is), 32};
+        REQUIRE(r.read<std::uint8_t>() == 7);
+        REQUIRE(r.read<std::vector<std::uint32_t>>() == vec);
+        REQUIRE(r.read<std::string>() == str);
+        REQUIRE(r.read<std::uint64_t>() == 0x1122334455667788);
+        REQUIRE(r.at_end());
+        REQUIRE(!r.err());
+    }
+}
+
+TEST_CASE("record_file")
+{
+    using namespace kl;
+
+    const char* path = "test_records.tmp";
+
+    auto make_record = [](std::size_t i) {
+        return reflectable_type{static_cast<std::uint16_t>(i),
+                                std::string(i % 17, 'a'),
+                                std::vector<float>(i % 5, 1.5f)};
+    };
+
+    {
+        record_file_writer writer{path, length_format::varint};
+        for (std::size_t i = 0; i < 100; ++i)
+            writer.append(make_record(i));
+        REQUIRE(writer.size() == 100);
+        writer.close();
+    }
+
+    SECTION("random access")
+    {
+        record_file file{path};
+        REQUIRE(file.size() == 100);
+
+        for (const std::size_t i : {57, 0, 99, 13})
+        {
+            const auto rec = file.read<reflectable_type>(i);
+            REQUIRE(rec.id == i);
+            REQUIRE(rec.name == make_record(i).name);
+            REQUIRE(rec.values == make_record(i).values);
+        }
+
+        REQUIRE_THROWS_AS(file.record(100), std::out_of_range);
+        REQUIRE_THROWS_AS(file.read<std::uint16_t>(1), record_file_error);
+    }
+
+    SECTION("sequential")
+    {
+        record_file file{path};
+        std::size_t i = 0;
+        for (const auto rec : file)
+        {
+            auto r = file.reader(rec);
+            REQUIRE(r.prefix_format() == length_format::varint);
+            REQUIRE(r.read<reflectable_type>().id == i);
+            REQUIRE(r.empty());
+            ++i;
+        }
+        REQUIRE(i == 100);
+    }
+
+    SECTION("records point into the mapped file")
+    {
+        record_file file{path};
+        auto r = file.reader(3);
+        REQUIRE(r.read<std::uint16_t>() == 3);
+        std::string_view name;
+        r >> name;
+        REQUIRE(name == "aaa");
+        REQUIRE(reinterpret_cast<const std::byte*>(name.data()) >
+                file.record(3).data());
+    }
+
+    SECTION("empty file")
+    {
+        record_file_writer{path};
+        record_file file{path};
+        REQUIRE(file.empty());
+        REQUIRE(file.begin() == file.end());
+    }
+
+    SECTION("closed writer")
+    {
+        record_file_writer writer{path};
+        writer.append(std::uint32_t{1});
+        writer.close();
+        writer.close();
+        REQUIRE_THROWS_AS(writer.append(std::uint32_t{2}), record_file_error);
+        REQUIRE(record_file{path}.size() == 1);
+    }
+
+    SECTION("from memory")
+    {
+        std::ifstream f{path, std::ios::binary};
+        const std::string contents{std::istreambuf_iterator<char>{f}, {}};
+        const auto bytes = gsl::as_bytes(gsl::span{contents});
+
+        record_file file{bytes};
+        REQUIRE(file.size() == 100);
+        REQUIRE(file.read<reflectable_type>(42).id == 42);
+        REQUIRE(file[42].data() > bytes.data());
+    }
+
+    SECTION("raw records")
+    {
+        const std::byte raw[] = {1_b, 2_b, 3_b};
+        {
+            record_file_writer writer{path};
+            writer.append_bytes(raw);
+            writer.append_bytes({});
+        }
+
+        record_file file{path};
+        REQUIRE(file.size() == 2);
+        REQUIRE(file[0] == gsl::span{raw});
+        REQUIRE(file[1].empty());
+    }
+
+    auto corrupt = [&](std::ptrdiff_t offset) {
+        std::fstream f{path, std::ios::in | std::ios::out | std::ios::binary};
+        f.seekg(offset, offset < 0 ? std::ios::end : std::ios::beg);
+        const auto c = static_cast<char>(f.peek() ^ 0x55);
+        f.seekp(offset, offset < 0 ? std::ios::end : std::ios::beg);
+        f.put(c);
+    };
+
+    SECTION("corrupted record")
+    {
+        // Inside the payload of the first record
+        corrupt(8 + 8 + 1);
+        record_file file{path};
+        REQUIRE_THROWS_AS(file.record(0), record_file_error);
+        REQUIRE(file.read<reflectable_type>(1).id == 1);
+    }
+
+    SECTION("corrupted index")
+    {
+        corrupt(-24 - 8);
+        REQUIRE_THROWS_AS(record_file{path}, record_file_error);
+    }
+
+    SECTION("incomplete file")
+    {
+        {
+            std::ofstream f{path, std::ios::app | std::ios::binary};
+            f << "garbage";
+        }
+        REQUIRE_THROWS_AS(record_file{path}, record_file_error);
+    }
+
+    SECTION("not a record file")
+    {
+        {
+            std::ofstream f{path, std::ios::trunc | std::ios::binary};
+            f << "Test\nHello.";
+        }
+        REQUIRE_THROWS_AS(record_file{path}, record_file_error);
+    }
+}
@@ -0,0 +1,79 @@
+#include "kl/crc32c.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+template <std::size_t N>
+gsl::span<const std::byte> as_span(const char (&str)[N])
+{
+    return gsl::span{reinterpret_cast<const std::byte*>(str),
+                     N - 1}; // get rid of trailing '\0'
+}
+
+// Bit by bit, straight from the definition
+std::uint32_t reference_crc32c(gsl::span<const std::byte> data)
+{
+    std::uint32_t crc = 0xffffffff;
+    for (const auto byte : data)
+    {
+        crc ^= std::to_integer<std::uint32_t>(byte);
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc >> 1) ^ (crc & 1 ? 0x82f63b78 : 0);
+    }
+    return ~crc;
+}
+} // namespace
+
+TEST_CASE("crc32c")
+{
+    SECTION("known values")
+    {
+        REQUIRE(kl::crc32c({}) == 0);
+        REQUIRE(kl::crc32c(as_span("a")) == 0xc1d04330);
+        REQUIRE(kl::crc32c(as_span("123456789")) == 0xe3069283);
+
+        const std::vector<std::byte> zeros(32);
+        REQUIRE(kl::crc32c(zeros) == 0x8a9136aa);
+        const std::vector<std::byte> ones(32, std::byte{0xff});
+        REQUIRE(kl::crc32c(ones) == 0x62a8ab43);
+    }
+
+    std::vector<std::byte> data(100'000);
+    std::uint32_t seed = 1;
+    for (auto& byte : data)
+    {
+        seed = seed * 1664525 + 1013904223;
+        byte = static_cast<std::byte>(seed >> 24);
+    }
+
+    SECTION("matches the definition for all sizes and alignments")
+    {
+        // Around the thresholds of the interleaved hardware paths
+        for (const std::size_t size :
+             {1, 7, 8, 9, 767, 768, 769, 1000, 24575, 24576, 24577, 99990})
+        {
+            for (const std::size_t offset : {0, 1, 3, 8})
+            {
+                const auto chunk = gsl::span{data}.subspan(offset, size);
+                REQUIRE(kl::crc32c(chunk) == reference_crc32c(chunk));
+            }
+        }
+    }
+
+    SECTION("incremental")
+    {
+        const auto whole = kl::crc32c(data);
+
+        std::uint32_t crc = 0;
+        for (std::size_t i = 0; i < data.size(); i += 997)
+        {
+            const auto size = (std::min)(std::size_t{997}, data.size() - i);
+            crc = kl::crc32c(crc, gsl::span{data}.subspan(i, size));
+        }
+        REQUIRE(crc == whole);
+    }
+}
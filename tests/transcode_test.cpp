@@ -0,0 +1,145 @@
+#include "kl/transcode.hpp"
+#include "kl/json.hpp"
+#include "kl/yaml.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+#include <string>
+
+TEST_CASE("transcode - yaml_to_json")
+{
+    using kl::transcode::yaml_to_json;
+
+    SECTION("scalars")
+    {
+        REQUIRE(yaml_to_json("a: 1\nb: -2.5e3\nc: true\nd: ~\ne: text\n") ==
+                R"({"a":1,"b":-2.5e3,"c":true,"d":null,"e":"text"})"
+                "\n");
+        // Quoted scalars stay strings
+        REQUIRE(yaml_to_json("['1', \"true\", '', \"null\"]") ==
+                R"(["1","true","","null"])"
+                "\n");
+    }
+
+    SECTION("core schema numbers")
+    {
+        REQUIRE(yaml_to_json("[+12, 007, -0, .5, +1., 1.e2, 0x1F, 0o17]") ==
+                "[12,7,-0,0.5,1,1e2,31,15]\n");
+        REQUIRE(yaml_to_json("[12345678901234567890123, 1_000, .inf]") ==
+                R"([12345678901234567890123,"1_000",".inf"])"
+                "\n");
+        // YAML 1.1 booleans are just strings
+        REQUIRE(yaml_to_json("[yes, off, True, FALSE]") ==
+                R"(["yes","off",true,false])"
+                "\n");
+    }
+
+    SECTION("nested")
+    {
+        const auto yaml = R"(
+name: svc
+endpoints:
+  - host: localhost
+    ports: [80, 443]
+  - {host: example.com, ports: []}
+limits: {}
+)";
+        REQUIRE(yaml_to_json(yaml) ==
+                R"({"name":"svc","endpoints":[{"host":"localhost","ports":)"
+                R"([80,443]},{"host":"example.com","ports":[]}],"limits":{}})"
+                "\n");
+    }
+
+    SECTION("scalar keys")
+    {
+        REQUIRE(yaml_to_json("{1: a, true: b, ~: c, 'x': d}") ==
+                R"({"1":"a","true":"b","null":"c","x":"d"})"
+                "\n");
+        REQUIRE_THROWS_AS(yaml_to_json("{[1, 2]: a}"),
+                          kl::transcode::transcode_error);
+        REQUIRE_THROWS_AS(yaml_to_json("? {a: 1}\n: b\n"),
+                          kl::transcode::transcode_error);
+    }
+
+    SECTION("aliases are expanded")
+    {
+        const auto yaml = R"(
+base: &base {cpu: 2, tags: [a, &tag b]}
+copy: *base
+tag: *tag
+*tag : key
+)";
+        REQUIRE(yaml_to_json(yaml) ==
+                R"({"base":{"cpu":2,"tags":["a","b"]},)"
+                R"("copy":{"cpu":2,"tags":["a","b"]},"tag":"b","b":"key"})"
+                "\n");
+    }
+
+    SECTION("documents")
+    {
+        REQUIRE(yaml_to_json("") == "");
+        REQUIRE(yaml_to_json("1\n---\n[a]\n---\n{a: b}\n") ==
+                "1\n[\"a\"]\n{\"a\":\"b\"}\n");
+    }
+
+    SECTION("streams")
+    {
+        std::istringstream in{"a: [1, 2]\n"};
+        std::ostringstream out;
+        yaml_to_json(in, out);
+        REQUIRE(out.str() == "{\"a\":[1,2]}\n");
+    }
+
+    SECTION("invalid YAML")
+    {
+        REQUIRE_THROWS_AS(yaml_to_json("[{]}"), kl::yaml::parse_error);
+    }
+}
+
+TEST_CASE("transcode - json_to_yaml")
+{
+    using kl::transcode::json_to_yaml;
+
+    SECTION("scalars")
+    {
+        REQUIRE(json_to_yaml(R"({"a":1,"b":-2.5e3,"c":true,"d":null})") ==
+                "a: 1\nb: -2.5e3\nc: true\nd: ~");
+        REQUIRE(json_to_yaml(R"(["text", "1", "true", "yes", "null", ""])") ==
+                "- text\n- \"1\"\n- \"true\"\n- \"yes\"\n- \"null\"\n- \"\"");
+    }
+
+    SECTION("nested")
+    {
+        REQUIRE(json_to_yaml(R"({"a":{"b":[1,{"c":[]}]},"d":{}})") ==
+                "a:\n  b:\n    - 1\n    - c:\n        []\nd:\n  {}");
+    }
+
+    SECTION("documents")
+    {
+        REQUIRE(json_to_yaml("") == "");
+        REQUIRE(json_to_yaml("1\n[2]\n{\"a\":3}\n") ==
+                "1\n---\n- 2\n---\na: 3");
+    }
+
+    SECTION("streams")
+    {
+        std::istringstream in{R"({"a": [1, 2]})"};
+        std::ostringstream out;
+        json_to_yaml(in, out);
+        REQUIRE(out.str() == "a:\n  - 1\n  - 2");
+    }
+
+    SECTION("invalid JSON")
+    {
+        REQUIRE_THROWS_AS(json_to_yaml("[1,"), kl::json::parse_error);
+        REQUIRE_THROWS_AS(json_to_yaml("{\"a\" 1}"), kl::json::parse_error);
+    }
+
+    SECTION("round trip")
+    {
+        const auto json = R"({"s":"12","n":12,"l":[true,null,"x"],"m":{}})"
+                          "\n";
+        REQUIRE(kl::transcode::yaml_to_json(json_to_yaml(json)) == json);
+    }
+}
@@ -0,0 +1,152 @@
+#include "kl/yaml_cache.hpp"
+#include "kl/reflect_struct.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct endpoint
+{
+    std::string host;
+    int port{};
+};
+KL_REFLECT_STRUCT(endpoint, host, port)
+
+struct service_config
+{
+    std::string name;
+    std::vector<endpoint> endpoints;
+    std::map<std::string, double> limits;
+    std::optional<int> threads;
+};
+KL_REFLECT_STRUCT(service_config, name, endpoints, limits, threads)
+
+void write_file(const std::string& path, const std::string& contents)
+{
+    std::ofstream strm{path, std::ios::trunc | std::ios::out |
+                                 std::ios::binary};
+    strm << contents;
+}
+
+const char* const config_yaml = R"(name: svc
+endpoints:
+  - host: localhost
+    port: 80
+  - host: example.com
+    port: 443
+limits:
+  cpu: 0.5
+  mem: 512
+)";
+} // namespace
+
+TEST_CASE("yaml_cache")
+{
+    const std::string path = "test-yaml-cache.yaml";
+    const std::string cache_dir = "test-yaml-cache.d";
+    write_file(path, config_yaml);
+    std::remove(kl::yaml::detail::cache_file_path(path, cache_dir).c_str());
+
+    SECTION("first load parses and writes the cache")
+    {
+        auto cfg = kl::yaml::cached_load<service_config>(path, cache_dir);
+        REQUIRE(cfg.name == "svc");
+        REQUIRE(cfg.endpoints.size() == 2);
+        REQUIRE(cfg.endpoints[1].host == "example.com");
+        REQUIRE(cfg.endpoints[1].port == 443);
+        REQUIRE(cfg.limits.at("mem") == 512.0);
+        REQUIRE(!cfg.threads);
+
+        std::ifstream cache{kl::yaml::detail::cache_file_path(path, cache_dir)};
+        REQUIRE(cache.good());
+
+        auto again = kl::yaml::cached_load<service_config>(path, cache_dir);
+        REQUIRE(again.name == cfg.name);
+        REQUIRE(again.endpoints.size() == 2);
+        REQUIRE(again.endpoints[0].host == "localhost");
+        REQUIRE(again.limits == cfg.limits);
+    }
+
+    SECTION("cache hit skips the YAML parse")
+    {
+        const kl::file_view source{path.c_str()};
+        const auto key = kl::yaml::detail::make_cache_key(
+            path, source.get_bytes(),
+            kl::yaml::detail::type_schema<service_config>());
+        const auto cache_path =
+            kl::yaml::detail::cache_file_path(path, cache_dir);
+
+        service_config cached;
+        cached.name = "from-cache";
+        cached.threads = 4;
+        REQUIRE(kl::yaml::detail::store_cached(cache_path, key, cached));
+
+        auto cfg = kl::yaml::cached_load<service_config>(path, cache_dir);
+        REQUIRE(cfg.name == "from-cache");
+        REQUIRE(cfg.threads == 4);
+        REQUIRE(cfg.endpoints.empty());
+    }
+
+    SECTION("stale cache falls back to a parse")
+    {
+        kl::yaml::cached_load<service_config>(path, cache_dir);
+
+        write_file(path, std::string{config_yaml} + "threads: 8\n");
+        auto cfg = kl::yaml::cached_load<service_config>(path, cache_dir);
+        REQUIRE(cfg.threads == 8);
+    }
+
+    SECTION("corrupt cache falls back to a parse")
+    {
+        kl::yaml::cached_load<service_config>(path, cache_dir);
+        const auto cache_path =
+            kl::yaml::detail::cache_file_path(path, cache_dir);
+
+        {
+            std::fstream cache{cache_path, std::ios::in | std::ios::out |
+                                               std::ios::binary};
+            cache.seekp(-3, std::ios::end);
+            cache.put('\x7f');
+        }
+
+        auto cfg = kl::yaml::cached_load<service_config>(path, cache_dir);
+        REQUIRE(cfg.name == "svc");
+        REQUIRE(cfg.endpoints.size() == 2);
+
+        write_file(cache_path, "garbage");
+        cfg = kl::yaml::cached_load<service_config>(path, cache_dir);
+        REQUIRE(cfg.name == "svc");
+    }
+
+    SECTION("type schema includes nested fields")
+    {
+        using kl::yaml::detail::type_schema;
+
+        const auto schema = type_schema<service_config>();
+        REQUIRE(schema.find("endpoints:") != std::string::npos);
+        REQUIRE(schema.find("host:") != std::string::npos);
+        REQUIRE(schema.find("port:int/" + std::to_string(sizeof(int))) !=
+                std::string::npos);
+        REQUIRE(schema.find("threads:") != std::string::npos);
+
+        // Same name and size, different fields
+        REQUIRE(type_schema<endpoint>() != type_schema<std::string>());
+        REQUIRE(type_schema<std::vector<endpoint>>() !=
+                type_schema<std::vector<int>>());
+    }
+
+    SECTION("invalid YAML")
+    {
+        write_file(path, "[{]}");
+        REQUIRE_THROWS_AS(
+            kl::yaml::cached_load<service_config>(path, cache_dir),
+            kl::yaml::parse_error);
+    }
+}
@@ -0,0 +1,202 @@
+#include "kl/yaml_live_config.hpp"
+#include "kl/reflect_struct.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// No operator== on purpose
+struct endpoint
+{
+    std::string host;
+    int port{};
+};
+KL_REFLECT_STRUCT(endpoint, host, port)
+
+struct http_config
+{
+    std::vector<endpoint> listen;
+    std::optional<endpoint> upstream;
+};
+KL_REFLECT_STRUCT(http_config, listen, upstream)
+
+struct app_config
+{
+    http_config http;
+    std::map<std::string, int> limits;
+    int threads{};
+    std::shared_ptr<const endpoint> admin;
+};
+KL_REFLECT_STRUCT(app_config, http, limits, threads, admin)
+
+void write_file(const std::string& path, const std::string& contents)
+{
+    std::ofstream strm{path, std::ios::trunc | std::ios::out |
+                                 std::ios::binary};
+    strm << contents;
+}
+
+const char* const config_yaml = R"(http:
+  listen:
+    - host: localhost
+      port: 80
+threads: 4
+limits:
+  cpu: 2
+)";
+} // namespace
+
+TEST_CASE("yaml live_config")
+{
+    const std::string path = "test-yaml-live-config.yaml";
+    write_file(path, config_yaml);
+
+    kl::yaml::live_config<app_config> config{path};
+    auto initial = config.get();
+    REQUIRE(initial->http.listen.size() == 1);
+    REQUIRE(initial->http.listen[0].port == 80);
+    REQUIRE(initial->threads == 4);
+
+    std::vector<std::string> fired;
+    config.on_change("http").connect(
+        [&](const app_config&) { fired.push_back("http"); });
+    config.on_change("limits").connect(
+        [&](const app_config&) { fired.push_back("limits"); });
+    config.on_change("threads").connect([&](const app_config& cfg) {
+        REQUIRE(config.get()->threads == cfg.threads);
+        fired.push_back("threads");
+    });
+    int any_changes = 0;
+    config.on_change().connect([&](const app_config&) { ++any_changes; });
+
+    SECTION("unknown field")
+    {
+        REQUIRE_THROWS_AS(config.on_change("http_"), std::invalid_argument);
+    }
+
+    SECTION("unchanged file")
+    {
+        REQUIRE(!config.reload());
+        REQUIRE(config.get() == initial);
+        REQUIRE(fired.empty());
+        REQUIRE(any_changes == 0);
+    }
+
+    SECTION("reformatted file with the same values")
+    {
+        write_file(path, "threads: 4\nlimits: {cpu: 2}\n"
+                         "http: {listen: [{host: localhost, port: 80}]}\n");
+        REQUIRE(!config.reload());
+        REQUIRE(config.get() != initial);
+        REQUIRE(fired.empty());
+        REQUIRE(any_changes == 0);
+    }
+
+    SECTION("only changed fields fire")
+    {
+        write_file(path, std::string{config_yaml} + "  mem: 512\n");
+        REQUIRE(config.reload());
+        REQUIRE(fired == std::vector<std::string>{"limits"});
+        REQUIRE(any_changes == 1);
+        REQUIRE(config.get()->limits.at("mem") == 512);
+        REQUIRE(initial->limits.count("mem") == 0);
+
+        fired.clear();
+        write_file(path, "http:\n"
+                         "  listen:\n"
+                         "    - host: localhost\n"
+                         "      port: 80\n"
+                         "  upstream: {host: backend, port: 8080}\n"
+                         "threads: 8\n"
+                         "limits: {}\n");
+        REQUIRE(config.reload());
+        REQUIRE(fired ==
+                std::vector<std::string>{"http", "limits", "threads"});
+        REQUIRE(any_changes == 2);
+        REQUIRE(config.get()->http.upstream->port == 8080);
+    }
+
+    SECTION("nested field change")
+    {
+        write_file(path, R"(http:
+  listen:
+    - host: localhost
+      port: 8080
+threads: 4
+limits:
+  cpu: 2
+)");
+        REQUIRE(config.reload());
+        REQUIRE(fired == std::vector<std::string>{"http"});
+        REQUIRE(config.get()->http.listen[0].port == 8080);
+    }
+
+    SECTION("shared_ptr fields compare pointees")
+    {
+        const std::string admin = "admin: {host: localhost, port: 9000}\n";
+        write_file(path, config_yaml + admin);
+        REQUIRE(config.reload());
+        REQUIRE(fired.empty());
+        REQUIRE(any_changes == 1);
+        REQUIRE(config.get()->admin->port == 9000);
+
+        write_file(path, "# same values\n" + (config_yaml + admin));
+        REQUIRE(!config.reload());
+        REQUIRE(any_changes == 1);
+    }
+
+    SECTION("invalid file keeps the current snapshot")
+    {
+        write_file(path, "threads: [1, 2]\n");
+        REQUIRE_THROWS_AS(config.reload(), kl::yaml::deserialize_error);
+        write_file(path, "[{]}");
+        REQUIRE_THROWS_AS(config.reload(), kl::yaml::parse_error);
+        REQUIRE(config.get() == initial);
+        REQUIRE(fired.empty());
+
+        // Recovers once the file is fixed
+        write_file(path, std::string{config_yaml} + "  mem: 1\n");
+        REQUIRE(config.reload());
+        REQUIRE(fired == std::vector<std::string>{"limits"});
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("yaml live_config - unordered containers")
+{
+    using kl::yaml::detail::values_equal;
+
+    std::unordered_map<std::string, endpoint> lhs, rhs;
+    rhs.reserve(1000); // Different bucket count, likely different order
+    for (int i = 0; i < 20; ++i)
+    {
+        lhs["ep" + std::to_string(i)] = endpoint{"localhost", i};
+        rhs["ep" + std::to_string(19 - i)] = endpoint{"localhost", 19 - i};
+    }
+    REQUIRE(values_equal(lhs, rhs));
+
+    rhs["ep7"].port = 8;
+    REQUIRE(!values_equal(lhs, rhs));
+    rhs["ep7"].port = 7;
+    rhs.erase("ep3");
+    REQUIRE(!values_equal(lhs, rhs));
+    rhs["ep20"] = endpoint{"localhost", 3};
+    REQUIRE(!values_equal(lhs, rhs));
+
+    std::unordered_multimap<int, endpoint> lhs_multi, rhs_multi;
+    lhs_multi.emplace(1, endpoint{"a", 1});
+    lhs_multi.emplace(1, endpoint{"b", 2});
+    rhs_multi.emplace(1, endpoint{"b", 2});
+    rhs_multi.emplace(1, endpoint{"a", 1});
+    REQUIRE(values_equal(lhs_multi, rhs_multi));
+}
@@ -15,8 +15,14 @@
 #include <deque>
 #include <list>
 #include <map>
+#include <memory>
 #include <optional>
 #include <string_view>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
 
 TEST_CASE("yaml")
 {
@@ -121,6 +127,14 @@ TEST_CASE("yaml")
         REQUIRE(obj.d == 1.0);
     }
 
+    SECTION("deserialize inner_t - duplicated and non-scalar keys")
+    {
+        auto y = "? [r]\n: 5\nd: 1.0\nr: 2\nr: 3\nd: 4.0"_yaml;
+        auto obj = yaml::deserialize<inner_t>(y);
+        REQUIRE(obj.r == 2);
+        REQUIRE(obj.d == 1.0);
+    }
+
     SECTION("deserialize Manual - missing one field")
     {
         auto y = "Ad: 1.0\nB: 22\nC: 6.777"_yaml;
@@ -811,6 +825,107 @@ TEST_CASE("yaml - overloading")
     REQUIRE(obj.w.value == 31);
 }
 
+namespace {
+
+// parse_scalar is expected to agree with YAML::Node::as<T> on every input
+template <typename T>
+bool same_as_yaml_cpp(const std::string& str)
+{
+    const auto node = YAML::Node{str};
+
+    T expected{};
+    const bool expected_ok = YAML::convert<T>::decode(node, expected);
+    T actual{};
+    const bool actual_ok = kl::yaml::parse_scalar(str, actual);
+
+    if (expected_ok != actual_ok)
+        return false;
+    if (!expected_ok)
+        return true;
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        if (expected != expected)
+            return actual != actual;
+    }
+    return expected == actual;
+}
+} // namespace
+
+TEST_CASE("yaml - parse_scalar")
+{
+    SECTION("agrees with yaml-cpp")
+    {
+        const std::vector<std::string> inputs = {
+            "0", "1", "-1", "+1", "127", "128", "-128", "-129", "255", "256",
+            "65535", "65536", "-32769", "2147483647", "2147483648",
+            "-2147483648", "-2147483649", "4294967295", "4294967296",
+            "9223372036854775807", "9223372036854775808",
+            "-9223372036854775808", "-9223372036854775809",
+            "18446744073709551615", "18446744073709551616", "0x7f", "0X80",
+            "-0x80", "0xFFFFFFFF", "0x", "010", "-010", "08", "00", "0.5",
+            "1.5", "-1.5", "+1.5", ".5", "5.", "1e3", "1E-3", "-1.5e+10",
+            "1e400", "-1e400", "1e", "1.2.3", "inf", "nan", ".inf", "+.Inf",
+            "-.INF", ".nan", ".NaN", ".NAN", ".Nan", "-.nan", "1 ", " 1",
+            "1\t", "--1", "+-1", "-+1", "-", "+", "", "abc", "12abc",
+            "0x1p3", "1_000", "true", "y"};
+
+        for (const auto& input : inputs)
+        {
+            INFO("input: " << input);
+            CHECK(same_as_yaml_cpp<signed char>(input));
+            CHECK(same_as_yaml_cpp<unsigned char>(input));
+            CHECK(same_as_yaml_cpp<short>(input));
+            CHECK(same_as_yaml_cpp<unsigned short>(input));
+            CHECK(same_as_yaml_cpp<int>(input));
+            CHECK(same_as_yaml_cpp<unsigned>(input));
+            CHECK(same_as_yaml_cpp<long>(input));
+            CHECK(same_as_yaml_cpp<unsigned long>(input));
+            CHECK(same_as_yaml_cpp<long long>(input));
+            CHECK(same_as_yaml_cpp<unsigned long long>(input));
+            CHECK(same_as_yaml_cpp<float>(input));
+            CHECK(same_as_yaml_cpp<double>(input));
+        }
+    }
+
+    SECTION("booleans")
+    {
+        const std::vector<std::string> inputs = {
+            "y",    "n",   "Y",   "N",     "yes",   "no",    "Yes",
+            "NO",   "yEs", "true", "false", "True", "FALSE", "tRUE",
+            "TRue", "on",  "off", "On",    "OFF",   "1",     "0",
+            "",     "yess", "t"};
+
+        for (const auto& input : inputs)
+        {
+            INFO("input: " << input);
+            CHECK(same_as_yaml_cpp<bool>(input));
+        }
+    }
+
+    SECTION("deserialize")
+    {
+        CHECK(kl::yaml::deserialize<int>("0x1F"_yaml) == 31);
+        CHECK(kl::yaml::deserialize<int>("-010"_yaml) == -8);
+        CHECK(kl::yaml::deserialize<std::uint8_t>("255"_yaml) == 255);
+        CHECK(kl::yaml::deserialize<double>("-.inf"_yaml) ==
+              -std::numeric_limits<double>::infinity());
+        CHECK(std::isnan(kl::yaml::deserialize<float>(".NaN"_yaml)));
+        CHECK(kl::yaml::deserialize<bool>("Off"_yaml) == false);
+        CHECK(
+            kl::yaml::deserialize<std::vector<float>>("[1, 2.5, -3e2]"_yaml) ==
+            std::vector<float>{1.0f, 2.5f, -300.0f});
+        CHECK(kl::yaml::deserialize<char>("x"_yaml) == 'x');
+
+        REQUIRE_THROWS_WITH(
+            kl::yaml::deserialize<bool>("maybe"_yaml),
+            "yaml-cpp: error at line 1, column 1: bad conversion");
+        REQUIRE_THROWS_WITH(
+            kl::yaml::deserialize<std::vector<double>>("[1, 2, x]"_yaml),
+            "yaml-cpp: error at line 1, column 8: bad conversion\n"
+            "error when deserializing element 2");
+    }
+}
+
 TEST_CASE("yaml - enum_set")
 {
     SECTION("to yaml")
@@ -1045,6 +1160,49 @@ TEST_CASE("yaml dump - custom context")
     CHECK(res == "value: 34\nother_non_secret: true");
 }
 
+TEST_CASE("yaml dump - stream sinks")
+{
+    using namespace kl;
+
+    SECTION("std::ostream")
+    {
+        std::ostringstream os;
+        yaml::dump(test_t{}, os);
+        CHECK(os.str() == yaml::dump(test_t{}));
+    }
+
+    SECTION("reused emitter")
+    {
+        YAML::Emitter emitter;
+        emitter << YAML::Flow << YAML::BeginSeq;
+        yaml::dump(inner_t{}, emitter);
+        yaml::dump(std::vector<int>{1, 2}, emitter);
+        emitter << YAML::EndSeq;
+        CHECK(std::string{emitter.c_str()} ==
+              "[{r: 1337, d: 3.1459259999999998}, [1, 2]]");
+    }
+
+    SECTION("file_sink")
+    {
+        std::vector<inner_t> values(1000);
+        {
+            yaml::file_sink sink{"test-yaml-sink.tmp", 256};
+            yaml::dump(values, sink);
+            sink.close();
+        }
+
+        std::ifstream file{"test-yaml-sink.tmp"};
+        std::string contents{std::istreambuf_iterator<char>{file}, {}};
+        CHECK(contents == yaml::dump(values));
+    }
+
+    SECTION("file_sink - can't open")
+    {
+        REQUIRE_THROWS_AS(yaml::file_sink{"not-existing-dir/test.tmp"},
+                          std::ios_base::failure);
+    }
+}
+
 TEST_CASE("yaml dump - extended")
 {
     using namespace std::chrono;
@@ -1301,3 +1459,145 @@ array:
                         "yaml-cpp: error at line 6, column 5: bad conversion\n"
                         "error when deserializing element 2");
 }
+
+TEST_CASE("yaml: load_all")
+{
+    SECTION("same documents as YAML::LoadAll")
+    {
+        const std::vector<std::string> inputs = {
+            "",
+            "# only a comment\n",
+            "a",
+            "---",
+            "---\n---\n",
+            "a: 1\n---\nb: 2\n",
+            "# head\n--- \nr: 1\n...\n---\nr: 2\n...\n",
+            "%YAML 1.2\n---\nr: 1\n...\n%YAML 1.2\n---\nr: 2\n",
+            "--- |\n  text\n  ---not a marker\n--- 3\n",
+            "r: 1\r\n---\r\nr: 2\r\n",
+            "r: 1\n...\nr: 2\n"};
+
+        for (const auto& input : inputs)
+        {
+            INFO("input: " << input);
+            const auto expected = YAML::LoadAll(input);
+            const auto documents = kl::yaml::detail::split_documents(input);
+            REQUIRE(documents.size() == expected.size());
+
+            for (std::size_t i = 0; i < documents.size(); ++i)
+            {
+                const auto node = YAML::Load(std::string{documents[i]});
+                CHECK(YAML::Dump(node) == YAML::Dump(expected[i]));
+            }
+        }
+    }
+
+    SECTION("keeps the document order")
+    {
+        std::string text;
+        for (int i = 0; i < 1000; ++i)
+            text += "---\nr: " + std::to_string(i) + "\nd: 0.5\n";
+
+        const auto docs = kl::yaml::load_all<inner_t>(text, 4);
+        REQUIRE(docs.size() == 1000);
+        for (int i = 0; i < 1000; ++i)
+            CHECK(docs[i].r == i);
+    }
+
+    SECTION("reports index of the failing document")
+    {
+        std::string text;
+        for (int i = 0; i < 100; ++i)
+            text += "---\nr: " + std::to_string(i) + "\nd: 0.5\n";
+        text += "---\nr: x\nd: 0.5\n---\nr: 1\n";
+
+        REQUIRE_THROWS_WITH(
+            kl::yaml::load_all<inner_t>(text, 4),
+            "yaml-cpp: error at line 2, column 4: bad conversion\n"
+            "error when deserializing field r\n"
+            "error when deserializing type " + kl::ctti::name<inner_t>() +
+                "\nerror when deserializing document 100");
+    }
+
+    SECTION("reports index of the document that can't be parsed")
+    {
+        const auto text = "r: 1\nd: 2\n---\n[{]}\n";
+        REQUIRE_THROWS_AS(kl::yaml::load_all<inner_t>(text),
+                          kl::yaml::parse_error);
+        REQUIRE_THROWS_WITH(kl::yaml::load_all<inner_t>(text),
+                            Catch::Matchers::EndsWith(
+                                "\nerror when parsing document 1"));
+    }
+}
+
+namespace {
+
+struct resource_t
+{
+    std::string name;
+    std::shared_ptr<const inner_t> profile;
+    std::shared_ptr<const std::vector<int>> ports;
+};
+KL_REFLECT_STRUCT(resource_t, name, profile, ports)
+} // namespace
+
+TEST_CASE("yaml: shared_ptr<const T> and aliases")
+{
+    SECTION("aliases share one object")
+    {
+        const auto node = R"(
+- name: a
+  profile: &p {r: 1, d: 2.5}
+  ports: &ports [80, 443]
+- name: b
+  profile: *p
+  ports: *ports
+- name: c
+  profile: {r: 1, d: 2.5}
+- name: d
+  profile: *p
+)"_yaml;
+        const auto res = kl::yaml::deserialize<std::vector<resource_t>>(node);
+        REQUIRE(res.size() == 4);
+        REQUIRE(res[0].profile);
+        REQUIRE(res[0].profile->r == 1);
+        REQUIRE(res[0].profile->d == Catch::Approx(2.5));
+        REQUIRE(res[1].profile == res[0].profile);
+        REQUIRE(res[3].profile == res[0].profile);
+        REQUIRE(res[1].ports == res[0].ports);
+        REQUIRE(*res[0].ports == std::vector<int>{80, 443});
+
+        // Same content without an alias is a separate object
+        REQUIRE(res[2].profile != res[0].profile);
+        REQUIRE(res[2].profile->r == 1);
+        REQUIRE(!res[2].ports);
+    }
+
+    SECTION("objects are not shared across deserialize calls")
+    {
+        const auto node = "{name: a, profile: {r: 3, d: 0}}"_yaml;
+        const auto r1 = kl::yaml::deserialize<resource_t>(node);
+        const auto r2 = kl::yaml::deserialize<resource_t>(node);
+        REQUIRE(r1.profile->r == 3);
+        REQUIRE(r2.profile->r == 3);
+        REQUIRE(r1.profile != r2.profile);
+    }
+
+    SECTION("null")
+    {
+        const auto node = "{name: a, profile: ~}"_yaml;
+        const auto res = kl::yaml::deserialize<resource_t>(node);
+        REQUIRE(!res.profile);
+        REQUIRE(!res.ports);
+    }
+
+    SECTION("serialize")
+    {
+        resource_t res{"a", std::make_shared<inner_t>(inner_t{4, 1.5}),
+                       nullptr};
+        const auto node = kl::yaml::serialize(res);
+        REQUIRE(node["profile"]["r"].as<int>() == 4);
+        REQUIRE(!node["ports"].IsDefined());
+        REQUIRE(kl::yaml::dump(res) == "name: a\nprofile:\n  r: 4\n  d: 1.5");
+    }
+}